@@ -0,0 +1,183 @@
+#! /usr/bin/env python3
+
+# Runs the neutron scenario (scratch/neutron) over a matrix of input files and
+# command-line parameters, one independent replication per seed, using every
+# available core.  Each run gets its own directory with its database, summary
+# and log, so runs never collide on scratch/database.db.  When all runs are
+# done the per-run summaries are aggregated into one table with the mean and
+# a 95% confidence interval of every counter across seeds.
+#
+# Example:
+#   ./experiments/neutron-sweep.py --inputs scratch/30nodes/input.yaml scratch/60nodes/input.yaml \
+#       --seeds 1-10 --loss 10 20 --balanced false true --output sweep-results
+
+import argparse
+import concurrent.futures
+import csv
+import glob
+import hashlib
+import itertools
+import json
+import math
+import os
+import subprocess
+import sys
+
+COUNTERS = [
+    "allocations",
+    "failures",
+    "reallocations",
+    "completed",
+    "preempted",
+    "battery_deaths",
+    "migrations",
+    "doomed",
+    "wasted_app_seconds",
+    "control_bytes_per_allocation",
+    "latency_mean",
+    "latency_p95",
+    "forwarded",
+    "recharges",
+]
+
+# Two-sided 95% Student t critical values, indexed by degrees of freedom
+T_95 = [
+    0.0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+]
+
+
+def parse_seeds(values):
+    """Expands a list of seeds where each entry is either N or FIRST-LAST."""
+    seeds = []
+    for value in values:
+        if "-" in value:
+            first, last = value.split("-", 1)
+            seeds.extend(range(int(first), int(last) + 1))
+        else:
+            seeds.append(int(value))
+    return seeds
+
+
+def find_binary(top_dir):
+    """Finds the neutron executable produced by ./ns3 build."""
+    candidates = glob.glob(os.path.join(top_dir, "build", "scratch", "neutron", "*main*"))
+    candidates = [c for c in candidates if os.access(c, os.X_OK) and not os.path.isdir(c)]
+    if not candidates:
+        sys.exit("neutron executable not found, build it first or pass --binary")
+    return sorted(candidates, key=os.path.getmtime)[-1]
+
+
+def run_one(binary, top_dir, run):
+    """Runs one replication and returns its summary row, or None if it failed."""
+    os.makedirs(run["dir"], exist_ok=True)
+    summary = os.path.join(run["dir"], "summary.csv")
+    args = [
+        binary,
+        "--input=" + run["input"],
+        "--database=" + os.path.join(run["dir"], "database.db"),
+        "--summary=" + summary,
+        "--seed=%d" % run["seed"],
+        "--loss=%d" % run["loss"],
+        "--balanced=" + run["balanced"],
+        "--powerless=" + run["powerless"],
+    ] + run["extra"]
+    with open(os.path.join(run["dir"], "run.log"), "w", encoding="utf-8") as log:
+        status = subprocess.call(args, cwd=top_dir, stdout=log, stderr=subprocess.STDOUT)
+    if status != 0 or not os.path.exists(summary):
+        return None
+    with open(summary, encoding="utf-8") as f:
+        return next(csv.DictReader(f))
+
+
+def confidence_interval(values):
+    """Returns (mean, half width of the 95% confidence interval)."""
+    n = len(values)
+    mean = sum(values) / n
+    if n < 2:
+        return mean, 0.0
+    variance = sum((v - mean) ** 2 for v in values) / (n - 1)
+    t = T_95[n - 1] if n - 1 < len(T_95) else 1.960
+    return mean, t * math.sqrt(variance / n)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Parallel parameter sweep for scratch/neutron")
+    parser.add_argument("--inputs", nargs="+", required=True, help="scenario YAML files")
+    parser.add_argument("--seeds", nargs="+", default=["1-5"], help="seeds, N or FIRST-LAST")
+    parser.add_argument("--loss", nargs="+", type=int, default=[20], help="battery loss percentages")
+    parser.add_argument("--balanced", nargs="+", default=["false"], help="values for --balanced")
+    parser.add_argument("--powerless", nargs="+", default=["true"], help="values for --powerless")
+    parser.add_argument("--extra", default="", help="extra arguments passed to every run")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="parallel runs")
+    parser.add_argument("--binary", default=None, help="neutron executable")
+    parser.add_argument("--output", default="neutron-sweep", help="directory for run outputs")
+    args = parser.parse_args()
+
+    top_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    binary = os.path.abspath(args.binary) if args.binary else find_binary(top_dir)
+    output = os.path.abspath(args.output)
+    extra = args.extra.split()
+
+    runs = []
+    for input_file, loss, balanced, powerless, seed in itertools.product(
+        args.inputs, args.loss, args.balanced, args.powerless, parse_seeds(args.seeds)
+    ):
+        config = (os.path.abspath(input_file), loss, balanced, powerless, " ".join(extra))
+        # The stem alone is ambiguous (every scenario is called input.yaml) and
+        # so is the parent directory when several files share one, so the name
+        # carries a hash of everything that changes the outcome but the seed
+        digest = hashlib.sha1(json.dumps(config).encode("utf-8")).hexdigest()[:10]
+        name = "%s-%s" % (os.path.splitext(os.path.basename(config[0]))[0], digest)
+        runs.append(
+            {
+                "config": config,
+                "input": config[0],
+                "loss": loss,
+                "balanced": balanced,
+                "powerless": powerless,
+                "seed": seed,
+                "extra": extra,
+                "dir": os.path.join(output, name, "seed%d" % seed),
+            }
+        )
+
+    print("Running %d replications on %d workers with %s" % (len(runs), args.jobs, binary))
+    results = {}
+    failed = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = {pool.submit(run_one, binary, top_dir, run): run for run in runs}
+        for future in concurrent.futures.as_completed(futures):
+            run = futures[future]
+            row = future.result()
+            if row is None:
+                failed += 1
+                print("FAIL %s" % run["dir"])
+                continue
+            results.setdefault(run["config"], []).append(row)
+            print("done %s" % run["dir"])
+
+    table = os.path.join(output, "summary.csv")
+    with open(table, "w", newline="", encoding="utf-8") as f:
+        writer = csv.writer(f)
+        header = ["input", "loss", "balanced", "powerless", "extra", "runs"]
+        for counter in COUNTERS:
+            header += [counter + "_mean", counter + "_ci95"]
+        writer.writerow(header)
+        for config in sorted(results):
+            rows = results[config]
+            line = list(config) + [len(rows)]
+            for counter in COUNTERS:
+                mean, half = confidence_interval([float(r[counter]) for r in rows])
+                line += ["%.3f" % mean, "%.3f" % half]
+            writer.writerow(line)
+
+    with open(table, encoding="utf-8") as f:
+        print(f.read())
+    print("%d runs failed" % failed if failed else "All runs succeeded")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
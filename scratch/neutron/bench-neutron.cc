@@ -0,0 +1,473 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "controller.h"
+#include "custom-node.h"
+#include "network-builder.h"
+#include "placement-engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+// mallinfo2 appeared in glibc 2.33; fork and getrusage need a POSIX system
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#define NEUTRON_HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#define NEUTRON_HAVE_FORK
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace ns3;
+using namespace std;
+
+// Micro-benchmarks for the neutron controller.  Each suite builds only what
+// it measures, so no network stack, database or scenario file is needed.
+// Unlike utils/bench-scheduler it links the scenario's own sources
+// (scratch-neutron-lib), so it is built here rather than under utils.
+//
+//   events  memory and time taken by pending finish events when every event
+//           carries a copy of the node container (the old controller) versus
+//           only application/worker ids resolved through a worker registry
+//   startup time and peak RSS to set up the workers, with and without the
+//           LrWpan network, each size and network in its own process
+//   controller
+//           latency percentiles of the placement engine's SelectWorker and of
+//           the controller's AllocateApp, DeallocateApp and OutOfPower on a
+//           synthetic cluster, with allocations per second and peak RSS,
+//           each size in its own process
+//
+// Heap bytes are reported as 0 without glibc, and without fork every
+// configuration runs in this process, so peak RSS is the peak so far.
+
+static double g_sink = 0.0;
+static vector<Ptr<CustomNode>> g_workers;
+
+static uint64_t HeapInUse()
+{
+#ifdef NEUTRON_HAVE_MALLINFO2
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+static double PeakRssMiB()
+{
+#ifdef NEUTRON_HAVE_FORK
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0); // bytes on macOS, KiB elsewhere
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+#else
+  return 0.0;
+#endif
+}
+
+// Runs one configuration in a child process so that its peak RSS is its own
+static void RunIsolated(const function<void()> &run, [[maybe_unused]] const string &what)
+{
+  cout.flush();
+#ifdef NEUTRON_HAVE_FORK
+  pid_t pid = fork();
+  if (pid == 0)
+  {
+    run();
+    cout.flush();
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    cerr << what << " failed" << endl;
+  }
+#else
+  run();
+#endif
+}
+
+static void FinishWithContainer(int idApplication, int idWorker, uint32_t generation, NodeContainer controlNodes)
+{
+  Ptr<CustomNode> node = DynamicCast<CustomNode>(controlNodes.Get(idWorker));
+  g_sink += node->GetCPU() + idApplication + generation;
+}
+
+static void FinishWithIds(int idApplication, int idWorker, uint32_t generation)
+{
+  g_sink += g_workers[idWorker - 1]->GetCPU() + idApplication + generation;
+}
+
+struct EventResult
+{
+  uint64_t bytes;
+  double scheduleSeconds;
+  double runSeconds;
+};
+
+static EventResult RunEvents(bool container, NodeContainer controlNodes, uint32_t apps, uint32_t seed)
+{
+  Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+  rv->SetStream(seed);
+  uint32_t workers = controlNodes.GetN() - 1;
+
+  uint64_t before = HeapInUse();
+  auto start = chrono::steady_clock::now();
+  for (uint32_t i = 1; i <= apps; ++i)
+  {
+    Time delay = Seconds(rv->GetValue(0.0, 86400.0));
+    int worker = 1 + (i % workers);
+    if (container)
+    {
+      Simulator::Schedule(delay, &FinishWithContainer, i, worker, 1u, controlNodes);
+    }
+    else
+    {
+      Simulator::Schedule(delay, &FinishWithIds, i, worker, 1u);
+    }
+  }
+  auto scheduled = chrono::steady_clock::now();
+  uint64_t after = HeapInUse();
+  Simulator::Run();
+  auto done = chrono::steady_clock::now();
+  Simulator::Destroy();
+
+  EventResult result;
+  result.bytes = after > before ? after - before : 0;
+  result.scheduleSeconds = chrono::duration<double>(scheduled - start).count();
+  result.runSeconds = chrono::duration<double>(done - scheduled).count();
+  return result;
+}
+
+static void PrintEvents(const char *name, const EventResult &result, uint32_t apps)
+{
+  cout << left << setw(12) << name << right
+       << setw(14) << result.bytes
+       << setw(12) << fixed << setprecision(1) << double(result.bytes) / apps
+       << setw(12) << setprecision(4) << result.scheduleSeconds
+       << setw(12) << result.runSeconds << endl;
+}
+
+static void BenchEvents(uint32_t workers, uint32_t apps, uint32_t seed)
+{
+  NodeContainer controlNodes;
+  for (uint32_t i = 0; i <= workers; ++i)
+  {
+    Ptr<CustomNode> node = CreateObject<CustomNode>();
+    node->SetAttribute("CPU", DoubleValue(1.0 + i % 4));
+    controlNodes.Add(node);
+    if (i > 0)
+    {
+      g_workers.push_back(node);
+    }
+  }
+
+  cout << "events: " << apps << " pending finish events over " << workers << " workers" << endl;
+  cout << left << setw(12) << "arguments" << right
+       << setw(14) << "heap bytes" << setw(12) << "bytes/event"
+       << setw(12) << "schedule s" << setw(12) << "run s" << endl;
+
+  // Ids first so the container run cannot reuse pages freed by the other one
+  EventResult ids = RunEvents(false, controlNodes, apps, seed);
+  EventResult copies = RunEvents(true, controlNodes, apps, seed);
+  PrintEvents("ids", ids, apps);
+  PrintEvents("container", copies, apps);
+  if (ids.bytes > 0)
+  {
+    cout << "container/ids memory ratio: " << setprecision(1) << double(copies.bytes) / ids.bytes << endl;
+  }
+  g_workers.clear();
+}
+
+static vector<uint32_t> ParseSizes(const string &list)
+{
+  vector<uint32_t> sizes;
+  stringstream stream(list);
+  string item;
+  while (getline(stream, item, ','))
+  {
+    sizes.push_back(stoul(item));
+  }
+  return sizes;
+}
+
+// Builds the scenario's nodes and controller the way main.cc does and prints one row
+static void RunStartup(NetworkMode network, uint32_t workers)
+{
+  auto start = chrono::steady_clock::now();
+  NodeContainer controlNodes;
+  controlNodes.Create(1);
+  Names::Add("Controller", controlNodes.Get(0));
+  for (uint32_t i = 0; i < workers; ++i)
+  {
+    Ptr<CustomNode> node = CreateObject<CustomNode>();
+    node->SetAttribute("Power", DoubleValue(100.0));
+    node->SetAttribute("InitialConsumption", DoubleValue(0.001157407));
+    node->SetAttribute("CurrentConsumption", DoubleValue(0.001157407));
+    node->SetAttribute("CPU", DoubleValue(1.0 + i % 4));
+    node->SetAttribute("Memory", DoubleValue(1.0 + i % 8));
+    node->SetAttribute("Transmission", DoubleValue(10.0));
+    node->SetAttribute("Storage", DoubleValue(16.0));
+    controlNodes.Add(node);
+    Names::Add("worker" + to_string(i), node);
+  }
+  if (network == NETWORK_LRWPAN)
+  {
+    InstallLrWpanNetwork(controlNodes, Seconds(3600));
+  }
+  Ptr<Controller> controller = CreateObject<Controller>();
+  controlNodes.Get(0)->AddApplication(controller);
+  controller->SetAudit(false);
+  controller->AddWorkers(controlNodes);
+  auto done = chrono::steady_clock::now();
+
+  cout << left << setw(10) << (network == NETWORK_LRWPAN ? "lrwpan" : "none") << right
+       << setw(10) << workers
+       << setw(14) << fixed << setprecision(3) << chrono::duration<double>(done - start).count()
+       << setw(16) << PeakRssMiB() << endl;
+  Names::Clear();
+  Simulator::Destroy();
+}
+
+struct ControllerMix
+{
+  vector<string> policies;
+  double demandScale;
+  uint32_t seed;
+};
+
+static vector<int> g_placedOn; // worker of every running application, 0 when not placed
+
+static void PlacedOn(int appId, int workerId)
+{
+  g_placedOn[appId] = workerId;
+}
+
+static void Removed(int appId, int /* workerId */)
+{
+  g_placedOn[appId] = 0;
+}
+
+static void PrintLatencies(const char *name, vector<double> &samples)
+{
+  if (samples.empty())
+  {
+    cout << left << setw(14) << name << right << setw(10) << 0 << endl;
+    return;
+  }
+  sort(samples.begin(), samples.end());
+  double total = 0.0;
+  for (double sample : samples)
+  {
+    total += sample;
+  }
+  auto at = [&samples](double p) { return samples[min(samples.size() - 1, size_t(p / 100.0 * samples.size()))] * 1e6; };
+  cout << left << setw(14) << name << right << setw(10) << samples.size()
+       << setw(11) << fixed << setprecision(2) << at(50) << setw(11) << at(90) << setw(11) << at(99)
+       << setw(11) << samples.back() * 1e6 << setw(14) << setprecision(0) << samples.size() / total << endl;
+}
+
+template <typename F>
+static double Timed(F operation)
+{
+  auto start = chrono::steady_clock::now();
+  operation();
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Fills a cluster with apps, then drains part of it, timing every operation
+static void RunController(uint32_t workers, uint32_t apps, const ControllerMix &mix)
+{
+  Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+  rv->SetStream(mix.seed);
+  NodeContainer controlNodes;
+  controlNodes.Create(1);
+  PlacementEngine engine;
+  for (uint32_t i = 0; i < workers; ++i)
+  {
+    Ptr<CustomNode> node = CreateObject<CustomNode>();
+    node->SetAttribute("Power", DoubleValue(100.0));
+    node->SetAttribute("InitialConsumption", DoubleValue(0.001157407));
+    node->SetAttribute("CurrentConsumption", DoubleValue(0.001157407));
+    node->SetAttribute("CPU", DoubleValue(1.0 + i % 4));
+    node->SetAttribute("Memory", DoubleValue(1.0 + i % 8));
+    node->SetAttribute("Transmission", DoubleValue(10.0));
+    node->SetAttribute("Storage", DoubleValue(16.0));
+    controlNodes.Add(node);
+    engine.AddWorker(node->GetCPU(), node->GetMemory(), node->GetStorage(), node->GetTransmission(), 100.0,
+                     0.001157407, 0.001157407);
+  }
+  Ptr<Controller> controller = CreateObject<Controller>();
+  controlNodes.Get(0)->AddApplication(controller);
+  controller->SetAudit(false);
+  controller->AddWorkers(controlNodes);
+  g_placedOn.assign(apps + 1, 0);
+  controller->TraceConnectWithoutContext("AppAllocated", MakeCallback(&PlacedOn));
+  controller->TraceConnectWithoutContext("AppFinished", MakeCallback(&Removed));
+  controller->TraceConnectWithoutContext("AppPreempted", MakeCallback(&Removed));
+
+  map<string, Ptr<PlacementPolicy>> policies;
+  for (const string &name : mix.policies)
+  {
+    policies[name] = PlacementPolicy::Create(name);
+  }
+  vector<double> selects;
+  vector<double> allocations;
+  vector<double> deallocations;
+  vector<double> depletions;
+  selects.reserve(apps);
+  allocations.reserve(apps);
+  for (uint32_t i = 1; i <= apps; ++i)
+  {
+    const string &policy = mix.policies[(i - 1) % mix.policies.size()];
+    double cpu = mix.demandScale * rv->GetValue(0.1, 1.0);
+    double memory = mix.demandScale * rv->GetValue(0.1, 2.0);
+    double storage = mix.demandScale * rv->GetValue(0.1, 4.0);
+    controller->AddApp(policy, 0.0, 3600.0, cpu, memory, storage);
+
+    // The engine alone, outside the controller, on a cluster filled the same way
+    int selected = 0;
+    Ptr<PlacementPolicy> named = policies[policy];
+    selects.push_back(Timed([&]() {
+      selected = named ? engine.SelectWorker(cpu, memory, storage, 3600.0, *named)
+                       : engine.SelectWorker(cpu, memory, storage, 3600.0,
+                                             PlacementEngine::ParsePolicy(policy.c_str()), false);
+    }));
+    if (selected > 0)
+    {
+      engine.Allocate(selected, cpu, memory, storage);
+    }
+    allocations.push_back(Timed([&]() { controller->AllocateApp(i); }));
+  }
+  double allocateTotal = 0.0;
+  for (double sample : allocations)
+  {
+    allocateTotal += sample;
+  }
+  uint64_t placed = controller->GetStats().ALLOCATIONS;
+
+  // Every other running application finishes, which also retries waiting ones
+  for (uint32_t i = 1; i <= apps; i += 2)
+  {
+    int worker = g_placedOn[i];
+    if (worker > 0)
+    {
+      deallocations.push_back(Timed([&]() { controller->DeallocateApp(i, worker, 1); }));
+    }
+  }
+  // Up to a thousand workers spread over the pool run out of power
+  uint32_t deaths = min(workers, 1000u);
+  for (uint32_t k = 0; k < deaths; ++k)
+  {
+    int worker = 1 + uint64_t(k) * workers / deaths;
+    depletions.push_back(Timed([&]() { controller->OutOfPower(worker); }));
+  }
+
+  cout << "controller: " << workers << " workers, " << apps << " apps" << endl;
+  cout << left << setw(14) << "operation" << right << setw(10) << "count"
+       << setw(11) << "p50 us" << setw(11) << "p90 us" << setw(11) << "p99 us"
+       << setw(11) << "max us" << setw(14) << "ops/s" << endl;
+  PrintLatencies("SelectWorker", selects);
+  PrintLatencies("AllocateApp", allocations);
+  PrintLatencies("DeallocateApp", deallocations);
+  PrintLatencies("OutOfPower", depletions);
+  cout << "placed " << placed << " of " << apps << ", " << setprecision(0)
+       << (allocateTotal > 0.0 ? placed / allocateTotal : 0.0) << " allocations/s, peak RSS "
+       << setprecision(1) << PeakRssMiB() << " MiB" << endl << endl;
+  Simulator::Destroy();
+}
+
+static void BenchController(const string &sizeList, uint32_t apps, const ControllerMix &mix)
+{
+  for (uint32_t workers : ParseSizes(sizeList))
+  {
+    RunIsolated([&]() { RunController(workers, apps, mix); },
+                "controller run with " + to_string(workers) + " workers");
+  }
+}
+
+static void BenchStartup(const string &sizeList)
+{
+  cout << "startup: node setup time and peak RSS per process" << endl;
+  cout << left << setw(10) << "network" << right << setw(10) << "workers"
+       << setw(14) << "setup s" << setw(16) << "peak RSS MiB" << endl;
+  for (uint32_t workers : ParseSizes(sizeList))
+  {
+    for (NetworkMode network : {NETWORK_NONE, NETWORK_LRWPAN})
+    {
+      if (network == NETWORK_LRWPAN && workers >= 65533)
+      {
+        cout << left << setw(10) << "lrwpan" << right << setw(10) << workers
+             << "  skipped, a single PAN holds at most 65532 workers" << endl;
+        continue;
+      }
+      RunIsolated([&]() { RunStartup(network, workers); },
+                  "startup run with " + to_string(workers) + " workers");
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  string suite = "events";
+  uint32_t workers = 180;
+  uint32_t apps = 100000;
+  uint32_t seed = 1;
+  string sizes = "1000,10000,100000";
+  string policies = "performance";
+  double demandScale = 1.0;
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("suite", "Benchmark to run: events, startup or controller", suite);
+  cmd.AddValue("workers", "Number of worker nodes", workers);
+  cmd.AddValue("apps", "Number of applications", apps);
+  cmd.AddValue("seed", "Random stream used for event times", seed);
+  cmd.AddValue("sizes", "Comma-separated worker counts for the startup and controller suites", sizes);
+  cmd.AddValue("policies", "Comma-separated placement policies the controller suite's apps cycle through", policies);
+  cmd.AddValue("demandScale", "Multiplier on the controller suite's CPU, memory and storage demands", demandScale);
+  cmd.Parse(argc, argv);
+
+  if (suite == "events")
+  {
+    BenchEvents(workers, apps, seed);
+  }
+  else if (suite == "startup")
+  {
+    BenchStartup(sizes);
+  }
+  else if (suite == "controller")
+  {
+    ControllerMix mix;
+    stringstream list(policies);
+    string policy;
+    while (getline(list, policy, ','))
+    {
+      mix.policies.push_back(policy);
+    }
+    if (mix.policies.empty())
+    {
+      mix.policies.push_back("performance");
+    }
+    mix.demandScale = demandScale;
+    mix.seed = seed;
+    BenchController(sizes, apps, mix);
+  }
+  else
+  {
+    cerr << "Unknown suite " << suite << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include "broker.h"
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("Broker");
+NS_OBJECT_ENSURE_REGISTERED(Broker);
+
+TypeId
+Broker::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::Broker")
+        .SetParent<Object>()
+        .SetGroupName("Applications")
+        .AddConstructor<Broker>()
+        .AddAttribute("ForwardDelay",
+                      "Delay of every message between the broker and a region.",
+                      TimeValue(MilliSeconds(10)),
+                      MakeTimeAccessor(&Broker::m_forwardDelay),
+                      MakeTimeChecker());
+    return tid;
+}
+
+Broker::Broker()
+    : m_forwardDelay(MilliSeconds(10)),
+      m_placedRemotely(0),
+      m_returned(0)
+{
+}
+
+void Broker::DoDispose()
+{
+    m_regions.clear();
+    Object::DoDispose();
+}
+
+uint32_t Broker::AddRegion(Ptr<Controller> region)
+{
+    uint32_t index = m_regions.size();
+    m_regions.push_back(region);
+    region->SetForwardCallback(MakeCallback(&Broker::Forward, this).Bind(index));
+    return index;
+}
+
+uint32_t Broker::GetNRegions() const { return m_regions.size(); }
+Ptr<Controller> Broker::GetRegion(uint32_t index) const { return m_regions[index]; }
+uint64_t Broker::GetPlacedRemotely() const { return m_placedRemotely; }
+uint64_t Broker::GetReturned() const { return m_returned; }
+
+int Broker::AddApp(std::string policy, float start, float duration, double cpu, double memory, double storage)
+{
+    uint32_t region = m_apps.size() % m_regions.size();
+    int localId = m_regions[region]->AddApp(policy, start, duration, cpu, memory, storage);
+    m_apps.emplace_back(region, localId);
+    return m_apps.size();
+}
+
+void Broker::AllocateApp(int appId)
+{
+    const std::pair<uint32_t, int> &app = m_apps[appId - 1];
+    m_regions[app.first]->AllocateApp(app.second);
+}
+
+void Broker::Forward(uint32_t home, int localId)
+{
+    Ptr<Controller> region = m_regions[home];
+    NS_LOG_DEBUG("Region " << home << " forwards application " << localId);
+    Schedule((home + 1) % m_regions.size(), &Broker::Offer, region->GetApp(localId), region->GetRemaining(localId),
+             home, 1);
+}
+
+void Broker::Offer(APP application, double remaining, uint32_t home, uint32_t attempt)
+{
+    uint32_t region = (home + attempt) % m_regions.size();
+    if (region == home)
+    {
+        m_returned++;
+        m_regions[home]->ReturnApp(application, remaining);
+        return;
+    }
+    if (m_regions[region]->TryAdoptApp(application, remaining))
+    {
+        m_placedRemotely++;
+        return;
+    }
+    Schedule((home + attempt + 1) % m_regions.size(), &Broker::Offer, application, remaining, home, attempt + 1);
+}
+
+void Broker::Schedule(uint32_t region, void (Broker::*handler)(APP, double, uint32_t, uint32_t),
+                      const APP &application, double remaining, uint32_t home, uint32_t attempt)
+{
+    // Runs in the context of the region's controller node, as a message to that region would
+    uint32_t context = m_regions[region]->GetNode()->GetId();
+    Simulator::ScheduleWithContext(context, m_forwardDelay, handler, this, application, remaining, home, attempt);
+}
+
+} // namespace ns3
@@ -0,0 +1,67 @@
+#ifndef BROKER_H
+#define BROKER_H
+
+#include "controller.h"
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Top level of the hierarchical mode.
+ *
+ * Each region is a Controller that owns its own workers, placement engine,
+ * pending queue and database, and shares no state with the others.  New
+ * applications are spread over the regions round-robin.  When a region
+ * finds no room for an application it hands it to the broker, which offers
+ * it to the other regions one at a time; if none takes it, it goes back to
+ * its home region and waits there under its original id.  An application
+ * is forwarded at most once: neither the region that adopts it nor its home
+ * region after a return offers it to the broker again.
+ *
+ * Every hop between the broker and a region is an event scheduled
+ * ForwardDelay ahead in the receiving region's context, so regions only
+ * interact through delayed messages and could be mapped to separate MPI
+ * ranks with ForwardDelay as the lookahead.
+ */
+class Broker : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  Broker ();
+
+  uint32_t AddRegion (Ptr<Controller> region);
+  uint32_t GetNRegions () const;
+  Ptr<Controller> GetRegion (uint32_t index) const;
+
+  int AddApp (std::string policy, float start, float duration, double cpu, double memory, double storage);
+  void AllocateApp (int appId);
+
+  uint64_t GetPlacedRemotely () const;
+  uint64_t GetReturned () const;
+
+private:
+  void DoDispose () override;
+
+  void Forward (uint32_t home, int localId);
+  void Offer (APP application, double remaining, uint32_t home, uint32_t attempt);
+  void Schedule (uint32_t region, void (Broker::*handler) (APP, double, uint32_t, uint32_t),
+                 const APP &application, double remaining, uint32_t home, uint32_t attempt);
+
+  Time m_forwardDelay;
+  std::vector<Ptr<Controller>> m_regions;
+  std::vector<std::pair<uint32_t, int>> m_apps; // region and local id, indexed by global id - 1
+  uint64_t m_placedRemotely;
+  uint64_t m_returned;
+};
+
+} // namespace ns3
+
+#endif // BROKER_H
@@ -0,0 +1,285 @@
+#include "control-plane.h"
+#include "custom-node.h"
+
+#include "ns3/inet6-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("ControlPlane");
+NS_OBJECT_ENSURE_REGISTERED(ControlHeader);
+NS_OBJECT_ENSURE_REGISTERED(WorkerAgent);
+
+static const uint32_t COMMON_SIZE = 5;  // type, sequence, worker
+static const uint32_t COMMAND_SIZE = 9; // op, app, generation
+
+TypeId
+ControlHeader::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::ControlHeader")
+        .SetParent<Header>()
+        .SetGroupName("Applications")
+        .AddConstructor<ControlHeader>();
+    return tid;
+}
+
+TypeId ControlHeader::GetInstanceTypeId(void) const { return GetTypeId(); }
+
+ControlHeader::ControlHeader()
+    : m_type(COMMANDS),
+      m_sequence(0),
+      m_worker(0),
+      m_power(0),
+      m_applications(0)
+{
+}
+
+void ControlHeader::SetType(Type type) { m_type = type; }
+ControlHeader::Type ControlHeader::GetType() const { return static_cast<Type>(m_type); }
+void ControlHeader::SetSequence(uint16_t sequence) { m_sequence = sequence; }
+uint16_t ControlHeader::GetSequence() const { return m_sequence; }
+void ControlHeader::SetWorker(uint16_t worker) { m_worker = worker; }
+uint16_t ControlHeader::GetWorker() const { return m_worker; }
+void ControlHeader::SetPower(double power) { m_power = std::clamp(power, 0.0, 100.0) * 100.0; }
+double ControlHeader::GetPower() const { return m_power / 100.0; }
+void ControlHeader::SetApplicationCount(uint16_t count) { m_applications = count; }
+uint16_t ControlHeader::GetApplicationCount() const { return m_applications; }
+void ControlHeader::AddCommand(const ControlCommand &command) { m_commands.push_back(command); }
+const std::vector<ControlCommand> &ControlHeader::GetCommands() const { return m_commands; }
+
+uint32_t ControlHeader::GetSerializedSize(void) const
+{
+    switch (m_type)
+    {
+    case COMMANDS:
+        return COMMON_SIZE + 1 + COMMAND_SIZE * m_commands.size();
+    case HEARTBEAT:
+        return COMMON_SIZE + 4;
+    default:
+        return COMMON_SIZE;
+    }
+}
+
+void ControlHeader::Serialize(Buffer::Iterator start) const
+{
+    start.WriteU8(m_type);
+    start.WriteHtonU16(m_sequence);
+    start.WriteHtonU16(m_worker);
+    if (m_type == COMMANDS)
+    {
+        start.WriteU8(m_commands.size());
+        for (const ControlCommand &command : m_commands)
+        {
+            start.WriteU8(command.op);
+            start.WriteHtonU32(command.app);
+            start.WriteHtonU32(command.generation);
+        }
+    }
+    else if (m_type == HEARTBEAT)
+    {
+        start.WriteHtonU16(m_power);
+        start.WriteHtonU16(m_applications);
+    }
+}
+
+uint32_t ControlHeader::Deserialize(Buffer::Iterator start)
+{
+    m_type = start.ReadU8();
+    m_sequence = start.ReadNtohU16();
+    m_worker = start.ReadNtohU16();
+    m_commands.clear();
+    if (m_type == COMMANDS)
+    {
+        uint8_t count = start.ReadU8();
+        for (uint8_t i = 0; i < count; ++i)
+        {
+            ControlCommand command;
+            command.op = start.ReadU8();
+            command.app = start.ReadNtohU32();
+            command.generation = start.ReadNtohU32();
+            m_commands.push_back(command);
+        }
+    }
+    else if (m_type == HEARTBEAT)
+    {
+        m_power = start.ReadNtohU16();
+        m_applications = start.ReadNtohU16();
+    }
+    return GetSerializedSize();
+}
+
+void ControlHeader::Print(std::ostream &os) const
+{
+    os << "type=" << static_cast<int>(m_type) << " seq=" << m_sequence << " worker=" << m_worker;
+    if (m_type == COMMANDS)
+    {
+        os << " commands=" << m_commands.size();
+    }
+    else if (m_type == HEARTBEAT)
+    {
+        os << " power=" << GetPower() << " apps=" << m_applications;
+    }
+}
+
+TypeId
+WorkerAgent::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::WorkerAgent")
+        .SetParent<Application>()
+        .SetGroupName("Applications")
+        .AddConstructor<WorkerAgent>()
+        .AddAttribute("Port",
+                      "UDP port the agent listens on for controller commands.",
+                      UintegerValue(9000),
+                      MakeUintegerAccessor(&WorkerAgent::m_port),
+                      MakeUintegerChecker<uint16_t>())
+        .AddAttribute("HeartbeatInterval",
+                      "Time between heartbeats sent to the controller (0 disables them).",
+                      TimeValue(Seconds(60)),
+                      MakeTimeAccessor(&WorkerAgent::m_heartbeatInterval),
+                      MakeTimeChecker());
+    return tid;
+}
+
+WorkerAgent::WorkerAgent()
+    : m_controllerPort(9),
+      m_port(9000),
+      m_workerId(0),
+      m_heartbeatInterval(Seconds(60))
+{
+    m_jitter = CreateObject<UniformRandomVariable>();
+}
+
+WorkerAgent::~WorkerAgent() {}
+
+void WorkerAgent::SetWorkerId(int workerId) { m_workerId = workerId; }
+
+void WorkerAgent::SetController(Ipv6Address address, uint16_t port)
+{
+    m_controller = address;
+    m_controllerPort = port;
+}
+
+void WorkerAgent::SetCommandCallback(Callback<void, int, const ControlCommand &> callback)
+{
+    m_commandCallback = callback;
+}
+
+void WorkerAgent::SetTrafficCallback(Callback<void, int, uint32_t> callback)
+{
+    m_trafficCallback = callback;
+}
+
+int64_t WorkerAgent::AssignStreams(int64_t stream)
+{
+    m_jitter->SetStream(stream);
+    return 1;
+}
+
+void WorkerAgent::StartApplication()
+{
+    m_socket = Socket::CreateSocket(GetNode(), TypeId::LookupByName("ns3::UdpSocketFactory"));
+    m_socket->Bind(Inet6SocketAddress(Ipv6Address::GetAny(), m_port));
+    m_socket->SetRecvCallback(MakeCallback(&WorkerAgent::Receive, this));
+    if (m_heartbeatInterval.IsStrictlyPositive())
+    {
+        // Spread the first heartbeats so the workers do not all contend for the channel at once
+        m_heartbeatEvent = Simulator::Schedule(m_heartbeatInterval * m_jitter->GetValue(),
+                                               &WorkerAgent::SendHeartbeat, this);
+    }
+}
+
+void WorkerAgent::StopApplication()
+{
+    m_heartbeatEvent.Cancel();
+    if (m_socket)
+    {
+        m_socket->Close();
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    }
+}
+
+void WorkerAgent::DoDispose()
+{
+    m_socket = nullptr;
+    m_commandCallback = Callback<void, int, const ControlCommand &>();
+    m_trafficCallback = Callback<void, int, uint32_t>();
+    Application::DoDispose();
+}
+
+void WorkerAgent::Receive(Ptr<Socket> socket)
+{
+    Ptr<Packet> packet;
+    Address from;
+    while ((packet = socket->RecvFrom(from)))
+    {
+        Ptr<CustomNode> node = DynamicCast<CustomNode>(GetNode());
+        if (node && node->GetPower() <= 0.0)
+        {
+            continue;
+        }
+        if (!m_trafficCallback.IsNull())
+        {
+            m_trafficCallback(m_workerId, packet->GetSize());
+        }
+        ControlHeader header;
+        packet->RemoveHeader(header);
+        if (header.GetType() != ControlHeader::COMMANDS)
+        {
+            continue;
+        }
+        NS_LOG_DEBUG("Worker " << m_workerId << " received " << header);
+
+        ControlHeader ack;
+        ack.SetType(ControlHeader::ACK);
+        ack.SetSequence(header.GetSequence());
+        ack.SetWorker(m_workerId);
+        Ptr<Packet> reply = Create<Packet>();
+        reply->AddHeader(ack);
+        Send(reply);
+
+        for (const ControlCommand &command : header.GetCommands())
+        {
+            if (!m_commandCallback.IsNull())
+            {
+                m_commandCallback(m_workerId, command);
+            }
+        }
+    }
+}
+
+void WorkerAgent::SendHeartbeat()
+{
+    Ptr<CustomNode> node = DynamicCast<CustomNode>(GetNode());
+    if (!node || node->GetPower() > 0.0)
+    {
+        ControlHeader heartbeat;
+        heartbeat.SetType(ControlHeader::HEARTBEAT);
+        heartbeat.SetWorker(m_workerId);
+        if (node)
+        {
+            heartbeat.SetPower(node->GetPower());
+            heartbeat.SetApplicationCount(node->GetApplications().size());
+        }
+        Ptr<Packet> packet = Create<Packet>();
+        packet->AddHeader(heartbeat);
+        Send(packet);
+    }
+    m_heartbeatEvent = Simulator::Schedule(m_heartbeatInterval, &WorkerAgent::SendHeartbeat, this);
+}
+
+void WorkerAgent::Send(Ptr<Packet> packet)
+{
+    m_socket->SendTo(packet, 0, Inet6SocketAddress(m_controller, m_controllerPort));
+    if (!m_trafficCallback.IsNull())
+    {
+        m_trafficCallback(m_workerId, packet->GetSize());
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+#ifndef CONTROL_PLANE_H
+#define CONTROL_PLANE_H
+
+#include "ns3/application.h"
+#include "ns3/callback.h"
+#include "ns3/header.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+struct ControlCommand
+{
+  uint8_t op;
+  uint32_t app;
+  uint32_t generation;
+};
+
+/**
+ * Payload of every control-plane datagram between the controller and the
+ * workers.
+ *
+ * COMMANDS carries a batch of placement commands from the controller,
+ * ACK acknowledges a batch by sequence number and HEARTBEAT reports a
+ * worker's battery level and load.  The encoding is kept compact (9 bytes
+ * per command) so a small batch still fits one 802.15.4 frame.
+ */
+class ControlHeader : public Header
+{
+public:
+  enum Type
+  {
+    COMMANDS = 1,
+    ACK,
+    HEARTBEAT
+  };
+
+  enum Op
+  {
+    ALLOCATE = 1,
+    DEALLOCATE
+  };
+
+  static TypeId GetTypeId (void);
+  TypeId GetInstanceTypeId (void) const override;
+
+  ControlHeader ();
+
+  void SetType (Type type);
+  Type GetType () const;
+  void SetSequence (uint16_t sequence);
+  uint16_t GetSequence () const;
+  void SetWorker (uint16_t worker);
+  uint16_t GetWorker () const;
+  void SetPower (double power);
+  double GetPower () const;
+  void SetApplicationCount (uint16_t count);
+  uint16_t GetApplicationCount () const;
+  void AddCommand (const ControlCommand &command);
+  const std::vector<ControlCommand> &GetCommands () const;
+
+  uint32_t GetSerializedSize (void) const override;
+  void Serialize (Buffer::Iterator start) const override;
+  uint32_t Deserialize (Buffer::Iterator start) override;
+  void Print (std::ostream &os) const override;
+
+private:
+  uint8_t m_type;
+  uint16_t m_sequence;
+  uint16_t m_worker;
+  uint16_t m_power; // hundredths of a percent
+  uint16_t m_applications;
+  std::vector<ControlCommand> m_commands;
+};
+
+/**
+ * Worker side of the control plane.
+ *
+ * Receives command batches from the controller over UDP, hands every
+ * command to the command callback, acknowledges the batch and sends a
+ * heartbeat every HeartbeatInterval while the node has power.  Bytes sent
+ * and received are reported through the traffic callback so the controller
+ * can charge their energy to the worker's battery.
+ */
+class WorkerAgent : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+
+  WorkerAgent ();
+  virtual ~WorkerAgent ();
+
+  void SetWorkerId (int workerId);
+  void SetController (Ipv6Address address, uint16_t port);
+  void SetCommandCallback (Callback<void, int, const ControlCommand &> callback);
+  void SetTrafficCallback (Callback<void, int, uint32_t> callback);
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  void StartApplication () override;
+  void StopApplication () override;
+  void DoDispose () override;
+
+  void Receive (Ptr<Socket> socket);
+  void SendHeartbeat ();
+  void Send (Ptr<Packet> packet);
+
+  Ptr<Socket> m_socket;
+  Ipv6Address m_controller;
+  uint16_t m_controllerPort;
+  uint16_t m_port;
+  int m_workerId;
+  Time m_heartbeatInterval;
+  EventId m_heartbeatEvent;
+  Ptr<UniformRandomVariable> m_jitter;
+  Callback<void, int, const ControlCommand &> m_commandCallback;
+  Callback<void, int, uint32_t> m_trafficCallback;
+};
+
+} // namespace ns3
+
+#endif // CONTROL_PLANE_H
@@ -1,11 +1,109 @@
 #include "controller.h"
+#include "ns3/double.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/log.h"
 #include "ns3/node-container.h"
-#include <iostream>
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 using namespace ns3;
 
+NS_LOG_COMPONENT_DEFINE("Controller");
+NS_OBJECT_ENSURE_REGISTERED(Controller);
+
+// 0 registered, 2 running and 3 pending still need a worker; 1 finished and 4 forwarded do not
+static bool IsUnfinished(int status)
+{
+    return status == 0 || status == 2 || status == 3;
+}
+
+TypeId
+Controller::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::Controller")
+        .SetParent<Application>()
+        .SetGroupName("Applications")
+        .AddConstructor<Controller>()
+        .AddAttribute("BatchSize",
+                      "Most placement commands sent to a worker in one datagram.",
+                      UintegerValue(8),
+                      MakeUintegerAccessor(&Controller::m_batchSize),
+                      MakeUintegerChecker<uint32_t>(1, 255))
+        .AddAttribute("BatchDelay",
+                      "How long commands for a worker wait for others to share their datagram.",
+                      TimeValue(MilliSeconds(50)),
+                      MakeTimeAccessor(&Controller::m_batchDelay),
+                      MakeTimeChecker())
+        .AddAttribute("RetransmitTimeout",
+                      "Time without an acknowledgement before a command batch is sent again.",
+                      TimeValue(Seconds(2)),
+                      MakeTimeAccessor(&Controller::m_retransmitTimeout),
+                      MakeTimeChecker())
+        .AddAttribute("ControlEnergyPerByte",
+                      "Battery percentage a worker spends per control byte it sends or receives.",
+                      DoubleValue(0.0),
+                      MakeDoubleAccessor(&Controller::m_energyPerByte),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("RechargeThreshold",
+                      "Battery level a harvesting worker must recharge to before it takes applications "
+                      "again; keep it above the 50% placement minimum.",
+                      DoubleValue(60.0),
+                      MakeDoubleAccessor(&Controller::m_rechargeThreshold),
+                      MakeDoubleChecker<double>(0.0))
+        .AddTraceSource("AppAdded",
+                        "An application was registered.",
+                        MakeTraceSourceAccessor(&Controller::m_appAddedTrace),
+                        "ns3::Controller::AppAddedTracedCallback")
+        .AddTraceSource("PlacementDecided",
+                        "A worker was chosen for an application, 0 if none could take it.",
+                        MakeTraceSourceAccessor(&Controller::m_placementDecidedTrace),
+                        "ns3::Controller::DecisionTracedCallback")
+        .AddTraceSource("AppAllocated",
+                        "An application was placed on a worker.",
+                        MakeTraceSourceAccessor(&Controller::m_appAllocatedTrace),
+                        "ns3::Controller::ApplicationTracedCallback")
+        .AddTraceSource("AppFinished",
+                        "An application left its worker after running to completion.",
+                        MakeTraceSourceAccessor(&Controller::m_appFinishedTrace),
+                        "ns3::Controller::ApplicationTracedCallback")
+        .AddTraceSource("AppPreempted",
+                        "An application was removed from a worker that ran out of power.",
+                        MakeTraceSourceAccessor(&Controller::m_appPreemptedTrace),
+                        "ns3::Controller::ApplicationTracedCallback")
+        .AddTraceSource("PlacementFailed",
+                        "No worker could take an application; the worker id is 0.",
+                        MakeTraceSourceAccessor(&Controller::m_placementFailedTrace),
+                        "ns3::Controller::ApplicationTracedCallback")
+        .AddTraceSource("WorkerDepleted",
+                        "A worker ran out of power.",
+                        MakeTraceSourceAccessor(&Controller::m_workerDepletedTrace),
+                        "ns3::Controller::WorkerTracedCallback")
+        .AddTraceSource("WorkerRecharged",
+                        "A harvester recharged a worker up to the recharge threshold.",
+                        MakeTraceSourceAccessor(&Controller::m_workerRechargedTrace),
+                        "ns3::Controller::WorkerTracedCallback");
+    return tid;
+}
+
 Controller::Controller() {
     m_socket = nullptr;
+    m_balanced = false;
+    m_audit = true;
+    m_reallocationCap = 64;
+    m_migrate = false;
+    m_checkpointInterval = 60.0;
+    m_controlPlane = false;
+    m_batchSize = 8;
+    m_batchDelay = MilliSeconds(50);
+    m_retransmitTimeout = Seconds(2);
+    m_energyPerByte = 0.0;
+    m_rechargeThreshold = 60.0;
+    m_unfinished = 0;
+    m_stats = STATS{};
 }
 
 Controller::~Controller() {
@@ -15,8 +113,13 @@ Controller::~Controller() {
 }
 
 void Controller::StartApplication() {
+    // Without a control plane there may be no network stack to open a socket on
+    if (!m_controlPlane)
+    {
+        return;
+    }
     m_socket = Socket::CreateSocket(GetNode(), TypeId::LookupByName("ns3::UdpSocketFactory"));
-    m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(),9));
+    m_socket->Bind(Inet6SocketAddress(Ipv6Address::GetAny(), CONTROLLER_PORT));
     m_socket->SetRecvCallback(MakeCallback(&Controller::ReceiveMessageFromWorker, this));
 }
 
@@ -26,15 +129,182 @@ void Controller::StopApplication() {
     }
 }
 
-void Controller::SendMessageToWorker(Ipv4Address address) {
-    Ptr<Packet> packet = Create<Packet>(1024);
-    std::cout << "Controller enviando mensagem para: " << address << std::endl;
-    m_socket->SendTo(packet, 0, InetSocketAddress(address, 7));
+// The controller may outlive Simulator::Destroy, so the audit rows must reach the disk here
+void Controller::DoDispose()
+{
+    db.Close();
+    Application::DoDispose();
+}
+
+void Controller::SendMessageToWorker(int idWorker, Ptr<Packet> packet) {
+    NS_LOG_DEBUG("Controller enviando mensagem para o worker " << idWorker);
+    m_socket->SendTo(packet, 0, Inet6SocketAddress(m_links[idWorker - 1].address, m_links[idWorker - 1].port));
+    m_stats.CONTROL_BYTES += packet->GetSize();
 }
 
 void Controller::ReceiveMessageFromWorker(Ptr<Socket> socket) {
-    Ptr<Packet> packet = socket->Recv();
-    std::cout << "Controller recebeu um pacote de um worker!" << std::endl;
+    Ptr<Packet> packet;
+    Address from;
+    while ((packet = socket->RecvFrom(from)))
+    {
+        m_stats.CONTROL_BYTES += packet->GetSize();
+        ControlHeader header;
+        packet->RemoveHeader(header);
+        int idWorker = header.GetWorker();
+        if (idWorker < 1 || idWorker > static_cast<int>(m_links.size()))
+        {
+            continue;
+        }
+        if (header.GetType() == ControlHeader::HEARTBEAT)
+        {
+            m_stats.HEARTBEATS++;
+        }
+        else if (header.GetType() == ControlHeader::ACK)
+        {
+            ControlLink &link = m_links[idWorker - 1];
+            auto it = link.unacked.find(header.GetSequence());
+            if (it != link.unacked.end())
+            {
+                it->second.timeout.Cancel();
+                link.unacked.erase(it);
+            }
+        }
+    }
+}
+
+void Controller::SetControlPlane(const Ipv6InterfaceContainer &interfaces)
+{
+    // Interface 0 is the controller, interface i is worker i; index 1 is the global address
+    m_controlPlane = true;
+    m_controlAddress = interfaces.GetAddress(0, 1);
+    m_links.resize(interfaces.GetN() - 1);
+    for (uint32_t i = 1; i < interfaces.GetN(); ++i)
+    {
+        m_links[i - 1].address = interfaces.GetAddress(i, 1);
+    }
+}
+
+void Controller::AddWorkerAgent(int idWorker, Ptr<WorkerAgent> agent)
+{
+    UintegerValue port;
+    agent->GetAttribute("Port", port);
+    m_links[idWorker - 1].port = port.Get();
+    agent->SetWorkerId(idWorker);
+    agent->SetController(m_controlAddress, CONTROLLER_PORT);
+    agent->SetCommandCallback(MakeCallback(&Controller::ReceiveCommand, this));
+    agent->SetTrafficCallback(MakeCallback(&Controller::ChargeControlEnergy, this));
+}
+
+const std::vector<double> &Controller::GetPlacementLatencies() const
+{
+    return m_latencies;
+}
+
+void Controller::SendCommand(int idWorker, uint8_t op, int idApplication, uint32_t generation)
+{
+    ControlLink &link = m_links[idWorker - 1];
+    link.queue.push_back(ControlCommand{op, static_cast<uint32_t>(idApplication), generation});
+    if (link.queue.size() >= m_batchSize)
+    {
+        link.flush.Cancel();
+        FlushCommands(idWorker);
+    }
+    else if (!link.flush.IsPending())
+    {
+        link.flush = Simulator::Schedule(m_batchDelay, &Controller::FlushCommands, this, idWorker);
+    }
+}
+
+bool Controller::IsStale(const ControlCommand &command) const
+{
+    return command.op == ControlHeader::ALLOCATE && !m_finishEvents.IsCurrent(command.app, command.generation);
+}
+
+void Controller::FlushCommands(int idWorker)
+{
+    ControlLink &link = m_links[idWorker - 1];
+    std::vector<ControlCommand> queue;
+    queue.swap(link.queue);
+    // A dead worker cannot hear anything, its applications were already moved elsewhere
+    if (m_workers[idWorker - 1]->GetPower() <= 0.0)
+    {
+        return;
+    }
+    queue.erase(std::remove_if(queue.begin(), queue.end(),
+                               [this](const ControlCommand &command) { return IsStale(command); }),
+                queue.end());
+    for (std::size_t first = 0; first < queue.size(); first += m_batchSize)
+    {
+        uint16_t sequence = link.sequence++;
+        Batch &batch = link.unacked[sequence];
+        std::size_t last = std::min<std::size_t>(queue.size(), first + m_batchSize);
+        batch.commands.assign(queue.begin() + first, queue.begin() + last);
+        SendBatch(idWorker, sequence);
+    }
+}
+
+void Controller::SendBatch(int idWorker, uint16_t sequence)
+{
+    ControlLink &link = m_links[idWorker - 1];
+    auto it = link.unacked.find(sequence);
+    if (it == link.unacked.end())
+    {
+        return;
+    }
+    Batch &batch = it->second;
+    batch.commands.erase(std::remove_if(batch.commands.begin(), batch.commands.end(),
+                                        [this](const ControlCommand &command) { return IsStale(command); }),
+                         batch.commands.end());
+    if (batch.commands.empty() || m_workers[idWorker - 1]->GetPower() <= 0.0)
+    {
+        link.unacked.erase(it);
+        return;
+    }
+    if (batch.sent)
+    {
+        m_stats.RETRANSMISSIONS++;
+    }
+    batch.sent = true;
+
+    ControlHeader header;
+    header.SetType(ControlHeader::COMMANDS);
+    header.SetSequence(sequence);
+    header.SetWorker(idWorker);
+    for (const ControlCommand &command : batch.commands)
+    {
+        header.AddCommand(command);
+    }
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(header);
+    SendMessageToWorker(idWorker, packet);
+    batch.timeout = Simulator::Schedule(m_retransmitTimeout, &Controller::SendBatch, this, idWorker, sequence);
+}
+
+void Controller::ReceiveCommand(int idWorker, const ControlCommand &command)
+{
+    // Retransmissions and commands overtaken by a preemption are ignored
+    if (command.op != ControlHeader::ALLOCATE || IsStale(command) || !m_awaitingStart[command.app - 1])
+    {
+        return;
+    }
+    m_latencies.push_back(Simulator::Now().GetSeconds() - m_decidedAt[command.app - 1]);
+    StartApp(command.app, idWorker, command.generation);
+}
+
+void Controller::ChargeControlEnergy(int idWorker, uint32_t bytes)
+{
+    if (m_energyPerByte <= 0.0)
+    {
+        return;
+    }
+    Ptr<CustomNode> node = m_workers[idWorker - 1];
+    double power = node->GetPower();
+    if (power <= 0.0)
+    {
+        return;
+    }
+    node->SetPower(std::max(0.0, power - bytes * m_energyPerByte));
+    ScheduleDepletion(idWorker);
 }
 
 void Controller::SetOptions(bool balanced)
@@ -42,164 +312,552 @@ void Controller::SetOptions(bool balanced)
     m_balanced = balanced;
 }
 
+void Controller::SetAudit(bool audit)
+{
+    m_audit = audit;
+}
+
+void Controller::SetReallocationCap(uint32_t cap)
+{
+    m_reallocationCap = cap;
+}
+
+void Controller::SetDatabaseOptions(const DatabaseOptions &options)
+{
+    m_dbOptions = options;
+}
+
+void Controller::SetLookahead(bool lookahead)
+{
+    m_engine.SetLookahead(lookahead);
+}
+
+void Controller::SetReplay(Callback<int, int> nextWorker)
+{
+    m_replay = nextWorker;
+}
+
+void Controller::SetMigration(bool migrate, double checkpointInterval)
+{
+    m_migrate = migrate;
+    m_checkpointInterval = checkpointInterval;
+}
+
 void Controller::AddWorkers(NodeContainer controlNodes)
 {
     for (uint32_t i = 1; i < controlNodes.GetN(); ++i)
     {
         Ptr<CustomNode> node = DynamicCast<CustomNode>(controlNodes.Get(i));
-        
-        db.AddNodeToDatabase(
-            node->GetPower(),
-            node->GetInitialConsumption(),
-            node->GetCurrentConsumption(),
-            node->GetCPU(),
-            node->GetMemory(),
-            node->GetTransmission(),
-            node->GetStorage(),
-            Names::FindName(node)
-        );
-        if (node->GetCurrentConsumption() > 0.0)
-        {
-            double duration = node->GetPower() / node->GetCurrentConsumption();
-            finishWkrBattery[i] = ns3::Simulator::Schedule(
-                ns3::Seconds(duration),
-                &Controller::OutOfPower,
-                this,
-                i,
-                controlNodes
+        m_workers.push_back(node);
+
+        m_engine.AddWorker(node->GetCPU(), node->GetMemory(), node->GetStorage(), node->GetTransmission(),
+                           node->GetPower(), node->GetCurrentConsumption(), node->GetInitialConsumption());
+        m_depletionGeneration.push_back(0);
+        if (m_audit)
+        {
+            db.AddNodeToDatabase(
+                node->GetPower(),
+                node->GetInitialConsumption(),
+                node->GetCurrentConsumption(),
+                node->GetCPU(),
+                node->GetMemory(),
+                node->GetTransmission(),
+                node->GetStorage(),
+                Names::FindName(node)
             );
         }
+        ScheduleDepletion(i);
     }
 }
 
-void Controller::AddApp(std::string policy, float start, float duration, double cpu, double memory, double storage)
+int Controller::AddApp(std::string policy, float start, float duration, double cpu, double memory, double storage)
 {
-    double currentTime = ns3::Simulator::Now().GetSeconds();
-    db.AddAppToDatabase(currentTime, policy, start, duration, cpu, memory, storage);
+    APP application;
+    application.ID = m_apps.size() + 1;
+    application.START = start;
+    application.DURATION = duration;
+    application.FINISH = 0;
+    application.CPU = cpu;
+    application.MEMORY = memory;
+    application.STORAGE = storage;
+    strncpy(application.POLICY, policy.c_str(), sizeof(application.POLICY) - 1);
+    application.POLICY[sizeof(application.POLICY) - 1] = '\0';
+    application.PLACEMENT = ResolvePolicy(policy);
+    m_apps.push_back(application);
+    m_runningSince.push_back(0.0);
+    m_decidedAt.push_back(0.0);
+    m_transfer.push_back(0.0);
+    m_awaitingStart.push_back(false);
+    m_remaining.push_back(duration);
+    m_forwardable.push_back(true);
+    AddUnfinished();
+
+    if (m_audit)
+    {
+        double currentTime = ns3::Simulator::Now().GetSeconds();
+        db.AddAppToDatabase(currentTime, policy, start, duration, cpu, memory, storage);
+    }
+    m_appAddedTrace(application.ID);
+    return application.ID;
 }
 
-void Controller::AllocateApp(int app_id, NodeContainer controlNodes)
+int Controller::SelectWorkerFor(const APP &application, double work)
 {
-    APP application = db.SelectApplicationById(app_id); 
-    for (uint32_t i = 1; i < controlNodes.GetN(); ++i)
+    if (application.PLACEMENT > 0)
     {
-        Ptr<CustomNode> node = DynamicCast<CustomNode>(controlNodes.Get(i));
-        node->AttPower();
-        db.UpdateNodeResources(i, node->GetPower());
+        return m_engine.SelectWorker(application.CPU, application.MEMORY, application.STORAGE,
+                                     work, *m_policies[application.PLACEMENT - 1]);
     }
-    double avgPower = db.HibridPolicy();
+    double avgPower = m_engine.GetAveragePower();
     if (avgPower > 50.0) {
         m_balanced = false;
     } else {
         m_balanced = true;
     }
-    WRK worker = db.SelectWorker(application.CPU, application.MEMORY, application.STORAGE, application.POLICY, m_balanced);
-    if (worker.ID > 0 && worker.ID < static_cast<int>(controlNodes.GetN())) {
+    return m_engine.SelectWorker(application.CPU, application.MEMORY, application.STORAGE,
+                                 work, PlacementEngine::ParsePolicy(application.POLICY), m_balanced);
+}
+
+void Controller::AllocateApp(int app_id)
+{
+    const APP &application = m_apps[app_id - 1];
+    double work = m_remaining[app_id - 1];
+    int workerId = m_replay.IsNull() ? -1 : m_replay(app_id);
+    if (workerId < 0)
+    {
+        workerId = SelectWorkerFor(application, work);
+    }
+    uint8_t reason = application.FINISH == 0 ? ARRIVAL : work < application.DURATION ? RESUME : RETRY;
+    m_placementDecidedTrace(app_id, workerId > 0 && workerId <= static_cast<int>(m_workers.size()) ? workerId : 0, reason);
+    if (workerId > 0 && workerId <= static_cast<int>(m_workers.size())) {
 
         double currentTime = ns3::Simulator::Now().GetSeconds();
-        db.InsertWorkerApplication(worker.ID, application.ID, currentTime);
-        db.MarkApplicationStatus(application.ID, "2", currentTime); // Marcando com 2 para sinalizar que está running
-        Ptr<CustomNode> node = DynamicCast<CustomNode>(controlNodes.Get(worker.ID));
+        Ptr<CustomNode> node = m_workers[workerId - 1];
+        m_stats.ALLOCATIONS++;
+        if (application.FINISH == 3)
+        {
+            m_stats.REALLOCATIONS++;
+        }
+        // A checkpoint has to reach the new worker before the application resumes
+        double transfer = 0.0;
+        if (work < application.DURATION)
+        {
+            m_stats.MIGRATIONS++;
+            if (node->GetTransmission() > 0.0)
+            {
+                transfer = (application.MEMORY + application.STORAGE) / node->GetTransmission();
+            }
+        }
+        if (!m_engine.Outlives(workerId, transfer + work))
+        {
+            m_stats.DOOMED++;
+        }
+        m_transfer[application.ID - 1] = transfer;
+        m_runningSince[application.ID - 1] = std::numeric_limits<double>::infinity();
+        m_decidedAt[application.ID - 1] = currentTime;
+        m_engine.Allocate(workerId, application.CPU, application.MEMORY, application.STORAGE);
+        if (m_audit)
+        {
+            db.UpdateNodeResources(workerId, node->GetPower());
+            db.InsertWorkerApplication(workerId, application.ID, currentTime);
+        }
+        SetApplicationStatus(application.ID, 2, currentTime); // Marcando com 2 para sinalizar que está running
         node->AddApplication(application.ID, application.CPU, application.MEMORY, application.STORAGE);
-        if (node->GetCurrentConsumption() > 0.0)
-        {
-            Simulator::Cancel(finishWkrBattery[worker.ID]);
-            double duration = node->GetPower() / node->GetCurrentConsumption();
-            finishWkrBattery[worker.ID] = ns3::Simulator::Schedule(
-                ns3::Seconds(duration),
-                &Controller::OutOfPower,
-                this,
-                worker.ID,
-                controlNodes
-            );
+        ScheduleDepletion(workerId);
+        uint32_t generation = m_finishEvents.Arm(application.ID);
+        if (m_controlPlane)
+        {
+            // The application starts when the command reaches the worker
+            m_awaitingStart[application.ID - 1] = true;
+            SendCommand(workerId, ControlHeader::ALLOCATE, application.ID, generation);
+        }
+        else
+        {
+            StartApp(application.ID, workerId, generation);
         }
-        finishIDApp[application.ID] = Simulator::Schedule(
-            Seconds(application.DURATION),
-            &Controller::DeallocateApp,
-            this,
-            application.ID, 
-            worker.ID,
-            controlNodes,
-            "1"); // Marcando com 1 para sinalizar que finalizou
-        
-        std::cout << "At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: ";
-        std::cout << "allocate_worker_application called in worker " << worker.ID << " and application " << application.ID << std::endl;
+
+        m_appAllocatedTrace(application.ID, workerId);
+        NS_LOG_INFO("At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: "
+                    << "allocate_worker_application called in worker " << workerId << " and application " << application.ID);
+    }
+    else if (!m_forwardCallback.IsNull() && m_forwardable[application.ID - 1]) {
+        // Another region may have room; the broker takes the application from here
+        double currentTime = ns3::Simulator::Now().GetSeconds();
+        m_stats.FORWARDED++;
+        SetApplicationStatus(application.ID, 4, currentTime); // Marcando com 4 para sinalizar que foi repassada ao broker
+        m_forwardCallback(application.ID);
     }
     else {
         double currentTime = ns3::Simulator::Now().GetSeconds();
-        db.MarkApplicationStatus(application.ID, "3", currentTime);  // Marcando com 3 para sinalizar que precisará rodar novamente
+        m_stats.FAILURES++;
+        m_placementFailedTrace(application.ID, 0);
+        SetApplicationStatus(application.ID, 3, currentTime);  // Marcando com 3 para sinalizar que precisará rodar novamente
     }
 }
 
-void Controller::DeallocateApp(int idApplication, int idWorker, NodeContainer controlNodes, std::string finish)
+void Controller::SetForwardCallback(Callback<void, int> callback)
+{
+    m_forwardCallback = callback;
+}
+
+uint32_t Controller::GetNWorkers() const
+{
+    return m_workers.size();
+}
+
+Ptr<CustomNode> Controller::GetWorker(int idWorker) const
+{
+    return m_workers[idWorker - 1];
+}
+
+const PlacementEngine &Controller::GetEngine() const
+{
+    return m_engine;
+}
+
+std::size_t Controller::GetPendingCount() const
+{
+    return m_pending.GetSize();
+}
+
+const APP &Controller::GetApp(int idApplication) const
+{
+    return m_apps[idApplication - 1];
+}
+
+double Controller::GetRemaining(int idApplication) const
+{
+    return m_remaining[idApplication - 1];
+}
+
+int Controller::Adopt(const APP &application, double remaining)
+{
+    int id = AddApp(application.POLICY, application.START, application.DURATION, application.CPU,
+                    application.MEMORY, application.STORAGE);
+    m_remaining[id - 1] = remaining;
+    // Only its home region hands it to the broker again, so it cannot bounce between regions
+    m_forwardable[id - 1] = false;
+    SetApplicationStatus(id, 3, Simulator::Now().GetSeconds());
+    return id;
+}
+
+bool Controller::TryAdoptApp(const APP &application, double remaining)
+{
+    // PLACEMENT indexes the home region's policies, this region resolves the name on its own
+    APP local = application;
+    local.PLACEMENT = ResolvePolicy(application.POLICY);
+    if (SelectWorkerFor(local, remaining) == 0)
+    {
+        return false;
+    }
+    AllocateApp(Adopt(application, remaining));
+    return true;
+}
+
+void Controller::ReturnApp(const APP &application, double remaining)
+{
+    // No region took it, so it waits here under its original id like any other pending application
+    int id = application.ID;
+    m_remaining[id - 1] = remaining;
+    m_forwardable[id - 1] = false;
+    SetApplicationStatus(id, 3, Simulator::Now().GetSeconds());
+    AllocateApp(id);
+}
+
+void Controller::StartApp(int idApplication, int idWorker, uint32_t generation)
+{
+    double currentTime = ns3::Simulator::Now().GetSeconds();
+    double transfer = m_transfer[idApplication - 1];
+    m_awaitingStart[idApplication - 1] = false;
+    m_runningSince[idApplication - 1] = currentTime + transfer;
+    m_finishEvents.Set(idApplication, Simulator::Schedule(
+        Seconds(transfer + m_remaining[idApplication - 1]),
+        &Controller::FinishApp,
+        this,
+        idApplication,
+        idWorker,
+        generation));
+}
+
+void Controller::FinishApp(int idApplication, int idWorker, uint32_t generation)
+{
+    if (!m_finishEvents.IsCurrent(idApplication, generation))
+    {
+        return;
+    }
+    m_stats.COMPLETED++;
+    DeallocateApp(idApplication, idWorker, 1); // Marcando com 1 para sinalizar que finalizou
+}
+
+void Controller::DeallocateApp(int idApplication, int idWorker, int finish)
 {
     double currentTime = ns3::Simulator::Now().GetSeconds();
-    Ptr<CustomNode> node = DynamicCast<CustomNode>(controlNodes.Get(idWorker));
-    APP application = db.SelectApplicationById(idApplication); 
+    m_finishEvents.Release(idApplication);
+    Ptr<CustomNode> node = m_workers[idWorker - 1];
+    const APP &application = m_apps[idApplication - 1];
     node->RemoveApplication(application.ID, application.CPU, application.MEMORY, application.STORAGE);
-    if (node->GetCurrentConsumption() > 0.0)
-    {
-        Simulator::Cancel(finishWkrBattery[idWorker]);
-        double duration = node->GetPower() / node->GetCurrentConsumption();
-        finishWkrBattery[idWorker] = ns3::Simulator::Schedule(
-            ns3::Seconds(duration),
-            &Controller::OutOfPower,
-            this,
-            idWorker,
-            controlNodes
-        );
-    }
-    db.RemoveWorkerApplication(idWorker, idApplication, currentTime);
-    db.MarkApplicationStatus(idApplication, finish, currentTime);
-
-    std::vector<int> appIds = db.GetApplicationsToReallocate();
-    for (int appId : appIds)
+    m_engine.Deallocate(idWorker, application.CPU, application.MEMORY, application.STORAGE);
+    ScheduleDepletion(idWorker);
+    if (m_audit)
+    {
+        db.RemoveWorkerApplication(idWorker, idApplication, currentTime);
+    }
+    SetApplicationStatus(idApplication, finish, currentTime);
+    m_appFinishedTrace(idApplication, idWorker);
+    if (m_controlPlane)
     {
-        AllocateApp(appId, controlNodes);
+        SendCommand(idWorker, ControlHeader::DEALLOCATE, idApplication, 0);
     }
+
+    ReallocateOnto(idWorker);
 }
 
-void Controller::OutOfPower(int idWorker, NodeContainer controlNodes)
+void Controller::OutOfPower(int idWorker)
 {
     double currentTime = ns3::Simulator::Now().GetSeconds();
-    Ptr<CustomNode> node = DynamicCast<CustomNode>(controlNodes.Get(idWorker));
+    Ptr<CustomNode> node = m_workers[idWorker - 1];
     std::vector<int> activeApps = node->GetApplications();
+    m_stats.BATTERY_DEATHS++;
+    m_stats.PREEMPTED += activeApps.size();
+    m_finishEvents.CancelAll(activeApps);
     for (int appId : activeApps)
     {
-        APP application = db.SelectApplicationById(appId); 
+        const APP &application = m_apps[appId - 1];
+        double elapsed = std::max(0.0, currentTime - m_runningSince[appId - 1]);
+        if (m_migrate)
+        {
+            // Only the work saved by the last checkpoint survives
+            double saved = elapsed;
+            if (m_checkpointInterval > 0.0)
+            {
+                saved = std::floor(elapsed / m_checkpointInterval) * m_checkpointInterval;
+            }
+            saved = std::min(saved, m_remaining[appId - 1]);
+            m_remaining[appId - 1] -= saved;
+            elapsed -= saved;
+        }
+        m_stats.WASTED_SECONDS += elapsed;
         node->RemoveApplication(application.ID, application.CPU, application.MEMORY, application.STORAGE);
-        Simulator::Cancel(finishIDApp[appId]);
-        db.RemoveWorkerApplication(idWorker, appId, currentTime);
-        db.MarkApplicationStatus(appId, "3", currentTime); // Marcando com 3 para sinalizar que precisará rodar novamente
+        m_engine.Deallocate(idWorker, application.CPU, application.MEMORY, application.STORAGE);
+        if (m_audit)
+        {
+            db.RemoveWorkerApplication(idWorker, appId, currentTime);
+        }
+        SetApplicationStatus(appId, 3, currentTime); // Marcando com 3 para sinalizar que precisará rodar novamente
+        m_appPreemptedTrace(appId, idWorker);
     }
+    m_workerDepletedTrace(idWorker);
+    // Descarta a previsão de esgotamento pendente deste worker e, se houver coleta de energia, prevê a recarga
+    node->SetPower(0.0);
+    ScheduleDepletion(idWorker);
 
-    std::vector<int> appIds = db.GetApplicationsToReallocate();
-    for (int appId : appIds)
+    // Nenhuma capacidade foi liberada, então só as aplicações deste worker tentam outro lugar
+    for (int appId : activeApps)
     {
-        AllocateApp(appId, controlNodes);
+        AllocateApp(appId);
     }
-    
-    //RechargePower(idWorker, controlNodes);
 
-    std::cout << "Node with ID " << idWorker << " ran out of power at " << currentTime << "s and all applications were removed." << std::endl;
+    NS_LOG_INFO("Node with ID " << idWorker << " ran out of power at " << currentTime << "s and all applications were removed.");
 }
 
-void Controller::RechargePower(int idWorker, NodeContainer controlNodes)
+void Controller::RechargePower(int idWorker)
 {
-    Ptr<CustomNode> node = DynamicCast<CustomNode>(controlNodes.Get(idWorker));
-    node->SetPower(100.0);
+    Ptr<CustomNode> node = m_workers[idWorker - 1];
+    m_stats.RECHARGES++;
+    m_workerRechargedTrace(idWorker);
+    // The event may land a rounding error short of the threshold; do not let it fire again
+    node->SetPower(std::max(node->GetPower(), m_rechargeThreshold));
+    // Readmite o worker no motor e oferece a ele só as aplicações pendentes que cabem nele
+    ScheduleDepletion(idWorker);
+    ReallocateOnto(idWorker);
 
-    //std::vector<int> appIds = db.GetApplicationsToReallocate();
-    //for (int appId : appIds)
-    //{
-    //    AllocateApp(appId, controlNodes);
-    //}
+    NS_LOG_INFO("Node with ID " << idWorker << " was recharged at " << ns3::Simulator::Now().GetSeconds() << "s and power is " << node->GetPower() << ".");
+}
 
-    std::cout << "Node with ID " << idWorker << " was recharged at " << ns3::Simulator::Now().GetSeconds() << "s and power set to 100." << std::endl;
+void Controller::ScheduleDepletion(int idWorker)
+{
+    Ptr<CustomNode> node = m_workers[idWorker - 1];
+    double now = ns3::Simulator::Now().GetSeconds();
+    double power = node->GetPower();
+    double consumption = node->GetCurrentConsumption();
+    // The engine projects a linear drain.  Given the bare consumption, a harvesting worker
+    // would leave its indexes long before its battery reaches the minimum power, and nothing
+    // would bring it back until it ran dry, so it gets the average net rate down to that
+    // crossing instead, and is refreshed when it gets there.  Without applications to place,
+    // an idle worker would cycle between the refresh and the recharge for ever.
+    double refresh = std::numeric_limits<double>::infinity();
+    if (node->GetHarvester() && m_unfinished > 0 && power > m_engine.GetMinPower())
+    {
+        refresh = node->GetCrossingTime(m_engine.GetMinPower());
+        if (std::isinf(refresh))
+        {
+            consumption = 0.0;
+        }
+        else if (Seconds(refresh) > Simulator::Now())
+        {
+            consumption = (power - m_engine.GetMinPower()) / (refresh - now);
+        }
+        else
+        {
+            // Already there up to the time resolution; another refresh would land on this instant
+            power = m_engine.GetMinPower();
+            refresh = std::numeric_limits<double>::infinity();
+        }
+    }
+    // Only this worker changed, so only its entry is refreshed; older entries become stale
+    m_engine.UpdateBattery(idWorker, power, consumption);
+    uint32_t generation = ++m_depletionGeneration[idWorker - 1];
+    // A harvesting worker gets one event at whichever threshold it crosses first.  It has to
+    // pass the minimum power before it can run dry, so the refresh always comes first.
+    double depletion = power > 0.0 && std::isinf(refresh) ? node->GetDepletionTime() : std::numeric_limits<double>::infinity();
+    double recharge = std::numeric_limits<double>::infinity();
+    if (node->GetHarvester() && power < m_rechargeThreshold)
+    {
+        recharge = node->GetCrossingTime(m_rechargeThreshold);
+    }
+    double next = std::min({depletion, recharge, refresh});
+    if (std::isinf(next))
+    {
+        return;
+    }
+    m_depletions.push(Depletion{Seconds(next), idWorker, generation, next == recharge, next == refresh && next < recharge});
+    if (m_depletions.top().generation == generation && m_depletions.top().worker == idWorker)
+    {
+        ArmDepletionTimer();
+    }
+}
+
+void Controller::ArmDepletionTimer()
+{
+    m_depletionEvent.Cancel();
+    if (!m_depletions.empty())
+    {
+        Time delay = Max(m_depletions.top().time - Simulator::Now(), Time(0));
+        m_depletionEvent = Simulator::Schedule(delay, &Controller::HandleDepletion, this);
+    }
+}
+
+void Controller::HandleDepletion()
+{
+    while (!m_depletions.empty() && m_depletions.top().time <= Simulator::Now())
+    {
+        Depletion next = m_depletions.top();
+        m_depletions.pop();
+        if (next.generation != m_depletionGeneration[next.worker - 1])
+        {
+            continue;
+        }
+        if (next.recharge)
+        {
+            RechargePower(next.worker);
+        }
+        else if (next.refresh)
+        {
+            ScheduleDepletion(next.worker);
+        }
+        else
+        {
+            OutOfPower(next.worker);
+        }
+    }
+    ArmDepletionTimer();
+}
+
+void Controller::SetApplicationStatus(int appId, int status, double currentTime)
+{
+    APP &application = m_apps[appId - 1];
+    if (IsUnfinished(status) && !IsUnfinished(application.FINISH))
+    {
+        AddUnfinished();
+    }
+    else if (!IsUnfinished(status) && IsUnfinished(application.FINISH))
+    {
+        m_unfinished--;
+    }
+    application.FINISH = status;
+    if (status == 3)
+    {
+        m_pending.Add(application);
+    }
+    else
+    {
+        m_pending.Remove(appId);
+    }
+    if (m_audit)
+    {
+        db.MarkApplicationStatus(appId, status, currentTime);
+    }
+}
+
+void Controller::AddUnfinished()
+{
+    if (m_unfinished++ == 0)
+    {
+        // The harvesting workers went without refreshes while there was nothing to place
+        for (uint32_t i = 1; i <= m_workers.size(); i++)
+        {
+            if (m_workers[i - 1]->GetHarvester())
+            {
+                ScheduleDepletion(i);
+            }
+        }
+    }
+}
+
+int Controller::ResolvePolicy(const std::string &name)
+{
+    // One instance per policy name, shared by every application that names it
+    auto it = m_policyIds.find(name);
+    if (it != m_policyIds.end())
+    {
+        return it->second;
+    }
+    int id = 0;
+    Ptr<PlacementPolicy> policy = PlacementPolicy::Create(name);
+    if (policy)
+    {
+        m_policies.push_back(policy);
+        id = m_policies.size();
+    }
+    m_policyIds[name] = id;
+    return id;
+}
+
+void Controller::ReallocateOnto(int idWorker)
+{
+    if (m_pending.GetSize() == 0 || m_engine.GetPower(idWorker) <= m_engine.GetMinPower())
+    {
+        return;
+    }
+    // Only applications that fit the capacity this worker has free can be placed now
+    std::vector<int> appIds = m_pending.GetCandidates(m_engine.GetCpuRemaining(idWorker),
+                                                      m_engine.GetMemoryRemaining(idWorker),
+                                                      m_engine.GetStorageRemaining(idWorker),
+                                                      m_reallocationCap);
+    for (int appId : appIds)
+    {
+        const APP &application = m_apps[appId - 1];
+        if (m_pending.Contains(appId) &&
+            application.CPU <= m_engine.GetCpuRemaining(idWorker) &&
+            application.MEMORY <= m_engine.GetMemoryRemaining(idWorker) &&
+            application.STORAGE <= m_engine.GetStorageRemaining(idWorker))
+        {
+            AllocateApp(appId);
+        }
+    }
+}
+
+const STATS &Controller::GetStats() const
+{
+    return m_stats;
 }
 
 void Controller::ResetDatabase()
 {
-    db.DropAllTables();
-    db.CreateAllTables();
-}
\ No newline at end of file
+    if (m_audit)
+    {
+        db.Open(m_dbOptions);
+        db.DropAllTables();
+        db.CreateAllTables();
+    }
+}
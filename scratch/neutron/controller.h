@@ -6,39 +6,177 @@
 #include "ns3/ipv4-address.h"
 #include "database.h"
 #include "custom-node.h"
+#include "placement-engine.h"
+#include "event-table.h"
+#include "pending-queue.h"
+#include "control-plane.h"
 #include "ns3/node-container.h"
 #include "ns3/ipv6-interface-container.h"
 #include "ns3/inet-socket-address.h"
+#include "ns3/traced-callback.h"
 #include "structs.h"
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
 
 namespace ns3 {
 
 class Controller : public Application {
 public:
+    static TypeId GetTypeId();
+
+    typedef void (*ApplicationTracedCallback)(int appId, int workerId);
+    typedef void (*WorkerTracedCallback)(int workerId);
+    typedef void (*AppAddedTracedCallback)(int appId);
+    typedef void (*DecisionTracedCallback)(int appId, int workerId, uint8_t reason);
+
+    // Why a placement attempt was made
+    enum DecisionReason : uint8_t
+    {
+        ARRIVAL = 0, // the application just arrived
+        RETRY,       // it was waiting for a worker
+        RESUME       // it was waiting and resumes from a checkpoint
+    };
+
     Controller();
     virtual ~Controller();
 
     virtual void StartApplication() override;
     virtual void StopApplication() override;
 
-    void SendMessageToWorker(Ipv4Address address);
-
     void SetOptions(bool balanced);
-    void AddWorkers(NodeContainer workerNodes);
-    void AddApp(std::string policy, float start, float duration, double cpu, double memory, double storage);
-    void AllocateApp(int app_id, NodeContainer workerNodes);
-    void DeallocateApp(int idApplication,int idWorker, NodeContainer controlNodes, std::string finish);
-    void OutOfPower(int idWorker, NodeContainer controlNodes);
-    void RechargePower(int idWorker, NodeContainer controlNodes);
+    void SetAudit(bool audit);
+    void SetDatabaseOptions(const DatabaseOptions &options);
+    void SetReallocationCap(uint32_t cap);
+    void SetLookahead(bool lookahead);
+    void SetMigration(bool migrate, double checkpointInterval);
+    void SetControlPlane(const Ipv6InterfaceContainer &interfaces);
+    void AddWorkerAgent(int idWorker, Ptr<WorkerAgent> agent);
+    void AddWorkers(NodeContainer controlNodes);
+    // Replay: the callback gives the worker recorded for the application's next attempt, or -1
+    void SetReplay(Callback<int, int> nextWorker);
+    int AddApp(std::string policy, float start, float duration, double cpu, double memory, double storage);
+    void AllocateApp(int app_id);
+    void DeallocateApp(int idApplication, int idWorker, int finish);
+    void OutOfPower(int idWorker);
+    void RechargePower(int idWorker);
     void ResetDatabase();
+    const STATS &GetStats() const;
+    const std::vector<double> &GetPlacementLatencies() const;
+
+    // Read-only views for samplers
+    uint32_t GetNWorkers() const;
+    Ptr<CustomNode> GetWorker(int idWorker) const;
+    const PlacementEngine &GetEngine() const;
+    std::size_t GetPendingCount() const;
+
+    // Hierarchical mode: applications that fit nowhere in this region go to the broker
+    void SetForwardCallback(Callback<void, int> callback);
+    const APP &GetApp(int idApplication) const;
+    double GetRemaining(int idApplication) const;
+    bool TryAdoptApp(const APP &application, double remaining);
+    void ReturnApp(const APP &application, double remaining);
 
 private:
+    static const uint16_t CONTROLLER_PORT = 9;
+
+    void DoDispose() override;
+
+    void SendMessageToWorker(int idWorker, Ptr<Packet> packet);
     void ReceiveMessageFromWorker(Ptr<Socket> socket);
+    void SendCommand(int idWorker, uint8_t op, int idApplication, uint32_t generation);
+    void FlushCommands(int idWorker);
+    void SendBatch(int idWorker, uint16_t sequence);
+    bool IsStale(const ControlCommand &command) const;
+    void ReceiveCommand(int idWorker, const ControlCommand &command);
+    void ChargeControlEnergy(int idWorker, uint32_t bytes);
+    void StartApp(int idApplication, int idWorker, uint32_t generation);
+    int SelectWorkerFor(const APP &application, double work);
+    int Adopt(const APP &application, double remaining);
+    void FinishApp(int idApplication, int idWorker, uint32_t generation);
+    void SetApplicationStatus(int appId, int status, double currentTime);
+    void AddUnfinished();
+    int ResolvePolicy(const std::string &name);
+    void ReallocateOnto(int idWorker);
+    void ScheduleDepletion(int idWorker);
+    void ArmDepletionTimer();
+    void HandleDepletion();
+
+    struct Depletion
+    {
+        Time time;
+        int worker;
+        uint32_t generation;
+        bool recharge; // crossing up to the recharge threshold rather than down to empty
+        bool refresh;  // harvesting worker reaching the engine's minimum power, only the engine is updated
+        bool operator>(const Depletion &other) const { return time > other.time; }
+    };
+
+    // Commands on their way to one worker
+    struct Batch
+    {
+        std::vector<ControlCommand> commands;
+        EventId timeout;
+        bool sent = false;
+    };
+
+    struct ControlLink
+    {
+        Ipv6Address address;
+        uint16_t port = 9000;
+        uint16_t sequence = 0;
+        std::vector<ControlCommand> queue;
+        EventId flush;
+        std::map<uint16_t, Batch> unacked;
+    };
+
     Ptr<Socket> m_socket;
     Database db;
-    ns3::EventId finishIDApp[100000];
-    ns3::EventId finishWkrBattery[100000];
+    std::vector<Ptr<CustomNode>> m_workers; // indexed by worker id - 1
+    DatabaseOptions m_dbOptions;
+    PlacementEngine m_engine;
+    std::vector<Ptr<PlacementPolicy>> m_policies;
+    std::map<std::string, int> m_policyIds;
+    std::vector<APP> m_apps;
+    std::vector<double> m_runningSince; // when each application last started (or resumed) running
+    std::vector<double> m_remaining;    // run time each application still needs
+    std::vector<double> m_transfer;     // checkpoint transfer time of the current placement
+    std::vector<double> m_decidedAt;    // when the current placement was decided
+    std::vector<bool> m_awaitingStart;  // placed, but the command has not reached the worker yet
+    std::vector<double> m_latencies;    // decision to start, one sample per delivered placement
+    std::vector<bool> m_forwardable;    // may still be handed to the broker
+    Callback<void, int> m_forwardCallback;
+    Callback<int, int> m_replay;
+    PendingQueue m_pending;
+    uint32_t m_reallocationCap;
+    STATS m_stats;
+
+    TracedCallback<int> m_appAddedTrace;
+    TracedCallback<int, int, uint8_t> m_placementDecidedTrace;
+    TracedCallback<int, int> m_appAllocatedTrace;
+    TracedCallback<int, int> m_appFinishedTrace;
+    TracedCallback<int, int> m_appPreemptedTrace;
+    TracedCallback<int, int> m_placementFailedTrace;
+    TracedCallback<int> m_workerDepletedTrace;
+    TracedCallback<int> m_workerRechargedTrace;
+    EventTable m_finishEvents;
+    std::priority_queue<Depletion, std::vector<Depletion>, std::greater<Depletion>> m_depletions;
+    std::vector<uint32_t> m_depletionGeneration;
+    uint32_t m_unfinished; // applications registered here that have neither finished nor been forwarded
+    ns3::EventId m_depletionEvent;
     bool m_balanced;
+    bool m_migrate;
+    double m_checkpointInterval;
+    bool m_controlPlane;
+    Ipv6Address m_controlAddress;
+    std::vector<ControlLink> m_links;
+    uint32_t m_batchSize;
+    Time m_batchDelay;
+    Time m_retransmitTimeout;
+    double m_energyPerByte;
+    double m_rechargeThreshold;
+    bool m_audit;
 };
 
 } // namespace ns3
@@ -1,5 +1,10 @@
 #include "custom-node.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("CustomNode");
@@ -46,7 +51,12 @@ CustomNode::GetTypeId(void)
                       "Storage capacity of the node.",
                       DoubleValue(0.0),
                       MakeDoubleAccessor(&CustomNode::m_storage),
-                      MakeDoubleChecker<double>());
+                      MakeDoubleChecker<double>())
+        .AddAttribute("Capacity",
+                      "Highest battery level a harvester can charge the node to.",
+                      DoubleValue(100.0),
+                      MakeDoubleAccessor(&CustomNode::m_capacity),
+                      MakeDoubleChecker<double>(0.0));
     return tid;
 }
 
@@ -58,13 +68,31 @@ CustomNode::CustomNode()
       m_memory(0.0),
       m_transmission(0.0),
       m_storage(0.0),
-      m_lastUpdate(0.0)
+      m_lastUpdate(0.0),
+      m_capacity(100.0)
 {
 }
 
 CustomNode::~CustomNode() {}
 
-double CustomNode::GetPower() const { return m_power; }
+void CustomNode::DoDispose()
+{
+    m_harvester = nullptr;
+    Node::DoDispose();
+}
+
+// A bateria é avaliada sob demanda a partir do último nível conhecido e do consumo atual
+double CustomNode::GetPower() const
+{
+    if (m_harvester)
+    {
+        return Advance(m_power, m_lastUpdate, ns3::Simulator::Now().GetSeconds());
+    }
+    double elapsed = ns3::Simulator::Now().GetSeconds() - m_lastUpdate;
+    double power = m_power - elapsed * m_currentConsumption;
+    return power < 0.0 ? 0.0 : power;
+}
+
 double CustomNode::GetInitialConsumption() const { return m_initialConsumption; }
 double CustomNode::GetCurrentConsumption() const { return m_currentConsumption; }
 double CustomNode::GetCPU() const { return m_cpu; }
@@ -75,8 +103,22 @@ const std::vector<int>& CustomNode::GetApplications() const { return m_applicati
 
 void CustomNode::SetPower(double power) {
     m_power = power;
+    m_lastUpdate = ns3::Simulator::Now().GetSeconds();
 }
 
+void CustomNode::SetInitialConsumption(double initialConsumption) { m_initialConsumption = initialConsumption; }
+
+// O nível da bateria é consolidado antes, para que o consumo antigo valha até agora
+void CustomNode::SetCurrentConsumption(double currentConsumption) {
+    AttPower();
+    m_currentConsumption = currentConsumption;
+}
+
+void CustomNode::SetCPU(double cpu) { m_cpu = cpu; }
+void CustomNode::SetMemory(double memory) { m_memory = memory; }
+void CustomNode::SetTransmission(double transmission) { m_transmission = transmission; }
+void CustomNode::SetStorage(double storage) { m_storage = storage; }
+
 void CustomNode::AddApplication(int appId, double cpu, double mem, double storage)
 {
     double currentTime = ns3::Simulator::Now().GetSeconds();
@@ -87,15 +129,10 @@ void CustomNode::AddApplication(int appId, double cpu, double mem, double storag
     //m_memory -= mem;
     //m_storage -= storage;
 
-    std::cout << "At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: ";
-    std::cout << "AddApplication called at CustomNode " << this->GetId() << std::endl;
-    std::cout << "Aplicações alocadas até agora: [ ";
-    for (int id : m_applications)
-    {
-        std::cout << id << " ";
-    }
-    std::cout << "]" << std::endl;
-    std::cout << "Consumo atualizado: " << m_currentConsumption << std::endl;
+    NS_LOG_INFO("At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: "
+                << "AddApplication called at CustomNode " << this->GetId() << "\n"
+                << "Aplicações alocadas até agora: [ " << FormatApplications() << "]\n"
+                << "Consumo atualizado: " << m_currentConsumption);
 }
 
 void CustomNode::RemoveApplication(int appId, double cpu, double mem, double storage)
@@ -109,31 +146,133 @@ void CustomNode::RemoveApplication(int appId, double cpu, double mem, double sto
     //m_memory += mem;
     //m_storage += storage;
 
-    std::cout << "At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: ";
-    std::cout << "RemoveApplication called at node " << this->GetId() << std::endl;
-    std::cout << "  > Application " << appId << " removed. Consumo atualizado: " << m_currentConsumption << std::endl;
-    std::cout << "Aplicações alocadas até agora: [ ";
+    NS_LOG_INFO("At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: "
+                << "RemoveApplication called at node " << this->GetId() << "\n"
+                << "  > Application " << appId << " removed. Consumo atualizado: " << m_currentConsumption << "\n"
+                << "Aplicações alocadas até agora: [ " << FormatApplications() << "]");
+}
+
+void CustomNode::AttPower()
+{
+    m_power = GetPower();
+    m_lastUpdate = ns3::Simulator::Now().GetSeconds();
+
+    //std::cout << "At time " << now << "s: ";
+    //std::cout << "Power updated for node " << this->GetId() << " | Consumption: " << m_currentConsumption << " | Power now: " << m_power << std::endl;
+}
+
+std::string CustomNode::FormatApplications() const
+{
+    std::ostringstream oss;
     for (int id : m_applications)
     {
-        std::cout << id << " ";
+        oss << id << " ";
     }
-    std::cout << "]" << std::endl;
+    return oss.str();
 }
 
-void CustomNode::AttPower()
+double CustomNode::GetDepletionTime() const
+{
+    return GetCrossingTime(0.0);
+}
+
+void CustomNode::SetHarvester(Ptr<BatteryHarvester> harvester)
 {
+    AttPower();
+    m_harvester = harvester;
+    if (m_harvester)
+    {
+        m_harvester->SetNode(this);
+    }
+}
+
+Ptr<BatteryHarvester> CustomNode::GetHarvester() const { return m_harvester; }
+
+// Between two breakpoints the battery only charges or only drains, so clamping once per piece is exact
+double CustomNode::Advance(double power, double from, double to) const
+{
+    double t = from;
+    while (t < to)
+    {
+        double end = std::min(to, m_harvester->GetNextBreakpoint(t, m_currentConsumption));
+        power += m_harvester->GetEnergy(t, end) - m_currentConsumption * (end - t);
+        power = std::clamp(power, 0.0, m_capacity);
+        t = end;
+    }
+    return power;
+}
+
+double CustomNode::GetCrossingTime(double level) const
+{
+    const double never = std::numeric_limits<double>::infinity();
     double now = ns3::Simulator::Now().GetSeconds();
-    double timeElapsed = now - m_lastUpdate;
-    double toSubtract = timeElapsed * m_currentConsumption;
-    m_power -= toSubtract;
-    if (m_power < 0.0)
+    double power = GetPower();
+    if (power == level)
     {
-        m_power = 0.0;
+        return now;
+    }
+    bool rising = level > power;
+    if (!m_harvester)
+    {
+        if (rising || m_currentConsumption <= 0.0)
+        {
+            return never;
+        }
+        return now + (power - level) / m_currentConsumption;
     }
-    m_lastUpdate = now;
 
-    //std::cout << "At time " << now << "s: ";
-    //std::cout << "Power updated for node " << this->GetId() << " | Consumption: " << m_currentConsumption << " | Power now: " << m_power << std::endl;
+    // Walk the pieces between breakpoints until one reaches the level.  Once a
+    // whole cycle ends without getting closer to it, the next cycles cannot either.
+    double period = m_harvester->GetPeriod();
+    double mark = period > 0.0 ? now + period : never;
+    double markPower = power;
+    double t = now;
+    for (uint32_t pieces = 0; pieces < 4096; ++pieces)
+    {
+        double end = std::min(m_harvester->GetNextBreakpoint(t, m_currentConsumption), mark);
+        if (std::isinf(end))
+        {
+            double rate = m_harvester->GetRate(t) - m_currentConsumption;
+            if (rising ? rate <= 0.0 : rate >= 0.0)
+            {
+                return never;
+            }
+            return t + (level - power) / rate;
+        }
+        double next = power + m_harvester->GetEnergy(t, end) - m_currentConsumption * (end - t);
+        if (rising ? next >= level : next <= level)
+        {
+            // The battery is monotonic inside the piece
+            double low = t;
+            double high = end;
+            for (int i = 0; i < 64 && high - low > 1e-6; ++i)
+            {
+                double middle = 0.5 * (low + high);
+                double value = power + m_harvester->GetEnergy(t, middle) - m_currentConsumption * (middle - t);
+                if (rising ? value >= level : value <= level)
+                {
+                    high = middle;
+                }
+                else
+                {
+                    low = middle;
+                }
+            }
+            return high;
+        }
+        power = std::clamp(next, 0.0, m_capacity);
+        t = end;
+        if (t >= mark)
+        {
+            if (rising ? power <= markPower : power >= markPower)
+            {
+                return never;
+            }
+            markPower = power;
+            mark += period;
+        }
+    }
+    return never;
 }
 
 } // namespace ns3
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "ns3/application.h"
 #include "ns3/node.h"
 #include "ns3/core-module.h"
+#include "harvester.h"
+#include <string>
 #include <vector>
 
 namespace ns3 {
@@ -41,8 +43,30 @@ public:
   const std::vector<int>& GetApplications() const;
 
   void AttPower ();
+  double GetDepletionTime () const;
+
+  /**
+   * Recharges the battery from a harvester, up to Capacity.  A node without
+   * a harvester only drains.
+   */
+  void SetHarvester (Ptr<BatteryHarvester> harvester);
+  Ptr<BatteryHarvester> GetHarvester () const;
+
+  /**
+   * First time, in seconds, at which the battery reaches level at the
+   * current consumption: falling to it if it is below the battery now,
+   * rising to it otherwise.  Infinity if it never does, or only more than
+   * about two years of harvest cycles ahead.
+   */
+  double GetCrossingTime (double level) const;
+
+protected:
+  void DoDispose () override;
 
 private:
+  std::string FormatApplications () const;
+  double Advance (double power, double from, double to) const;
+
   double m_power;
   double m_initialConsumption;
   double m_currentConsumption;
@@ -51,6 +75,8 @@ private:
   double m_transmission;
   double m_storage;
   double m_lastUpdate;
+  double m_capacity;
+  Ptr<BatteryHarvester> m_harvester;
   std::vector<int> m_applications;
 
 };
@@ -1,262 +1,289 @@
 #include "database.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
 #include <iostream>
 #include <sstream>
-#include <cstring>
 #include <iomanip>
 
-Database::Database() {
-    if (sqlite3_open("scratch/database.db", &db) != SQLITE_OK) {
-        std::cerr << "Erro ao abrir o banco de dados: " << sqlite3_errmsg(db) << std::endl;
-    } else {
-        std::cout << "Banco de dados aberto com sucesso" << std::endl;
-    }
-}
+NS_LOG_COMPONENT_DEFINE("Database");
 
-Database::~Database() {
-    if (db) {
-        sqlite3_close(db);
-        std::cout << "Banco de dados fechado." << std::endl;
-    }
-}
+static const char *g_statements[] = {
+    "INSERT INTO WORKERS (POWER, INITIAL_CONSUMPTION, CURRENT_CONSUMPTION, CPU, MEMORY, TRANSMISSION, STORAGE, NAME) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?);",
+    "INSERT INTO APPLICATIONS (START, DURATION, FINISH, CPU, MEMORY, STORAGE, POLICY) VALUES (?, ?, 0, ?, ?, ?, ?);",
+    "UPDATE WORKERS SET POWER = ? WHERE ID = ?;",
+    "INSERT INTO WORKERS_APPLICATIONS (ID_WORKER, ID_APPLICATION, PERFORMED_AT, FINISHED_AT) VALUES (?, ?, ?, 0);",
+    "UPDATE WORKERS_APPLICATIONS SET FINISHED_AT = ? WHERE ID_WORKER = ? AND ID_APPLICATION = ? AND FINISHED_AT = 0;",
+    "UPDATE APPLICATIONS SET FINISH = ? WHERE ID = ?;",
+};
 
-void Database::AddNodeToDatabase(double power, double initial_consumption, double current_consumption, double cpu, double memory, double transmission, double storage, std::string node_name)
+Database::Database()
+    : db(nullptr)
 {
-    std::ostringstream oss;
-    oss << "INSERT INTO WORKERS (POWER, INITIAL_CONSUMPTION, CURRENT_CONSUMPTION, CPU, MEMORY, TRANSMISSION, STORAGE, NAME) VALUES ("
-        << power << ", " 
-        << initial_consumption << ", " 
-        << current_consumption << ", " 
-        << cpu << ", " 
-        << memory << ", " 
-        << transmission << ", " 
-        << storage << ", "
-        << "'" << node_name << "');";
-    
-    if (ExecuteQuery(oss.str().c_str()))
+    for (int k = 0; k < ROW_KIND_COUNT; ++k)
     {
-        std::cout << "Inserting Node " << node_name << " to database with:\n"
-                << "  > Power = " << power << ";\n"
-                << "  > Initial Consumption = " << initial_consumption << ";\n"
-                << "  > Current Consumption = " << current_consumption << ";\n"
-                << "  > CPU = " << cpu << ";\n"
-                << "  > Memory = " << memory << ";\n"
-                << "  > Transmission = " << transmission << ";\n"
-                << "  > Storage = " << storage << ";\n"
-                << std::endl;
+        m_statements[k] = nullptr;
     }
 }
 
-void Database::UpdateNodeResources(int workerId, double updatedPower)
-{
-    std::ostringstream oss;
-    oss << "UPDATE WORKERS SET "
-        << "POWER = " << updatedPower
-        << " WHERE ID = " << workerId << ";";
-
-    ExecuteQuery(oss.str());
+Database::~Database() {
+    ns3::Simulator::Remove(m_destroyEvent);
+    Close();
 }
 
-
-void Database::AddAppToDatabase(double currentTime, std::string policy, float start, float duration, double cpu, double memory, double storage)
+void Database::Open(const DatabaseOptions &options)
 {
-    std::ostringstream oss;
-    oss << "INSERT INTO APPLICATIONS (START, DURATION, FINISH, CPU, MEMORY, STORAGE, POLICY) VALUES ("
-        << start << ", " << duration << ", 0, " << cpu << ", " << memory << ", " << storage << ", "
-        << "\"" << policy << "\");";
-    
+    if (db) {
+        return;
+    }
+    m_options = options;
+    const char *target = m_options.inMemory ? ":memory:" : m_options.path.c_str();
+    if (sqlite3_open(target, &db) != SQLITE_OK) {
+        std::cerr << "Erro ao abrir o banco de dados: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        db = nullptr;
+        return;
+    }
+    NS_LOG_INFO("Banco de dados aberto com sucesso");
 
-    if (ExecuteQuery(oss.str().c_str()))
+    if (m_options.wal && !m_options.inMemory)
     {
-        std::cout << "At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: ";
-        std::cout << "Inserting Application " << policy << " to database with:\n"
-                << "  > Start = " << start << ";\n"
-                << "  > Duration = " << duration << ";\n"
-                << "  > CPU = " << cpu << ";\n"
-                << "  > Memory = " << memory << ";\n"
-                << "  > Storage = " << storage << ";\n"
-                << std::endl;
+        ExecuteQuery("PRAGMA journal_mode = WAL;");
     }
-}
-
-APP Database::SelectApplicationById(int id)
-{
-    APP application;
-
-    std::ostringstream oss;
-    oss << "SELECT * FROM APPLICATIONS WHERE ID = " << id << ";";
-
-    sqlite3_stmt *stmt;
-    sqlite3_prepare_v2(db, oss.str().c_str(), -1, &stmt, nullptr);
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        application.ID = sqlite3_column_int(stmt, 0);
-        application.START = static_cast<float>(sqlite3_column_double(stmt, 1));
-        application.DURATION = static_cast<float>(sqlite3_column_double(stmt, 2));
-        application.FINISH = sqlite3_column_int(stmt, 3);
-        application.CPU = static_cast<float>(sqlite3_column_double(stmt, 4));
-        application.MEMORY = static_cast<float>(sqlite3_column_double(stmt, 5));
-        application.STORAGE = static_cast<float>(sqlite3_column_double(stmt, 6));
-
-        const char *policyText = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-        if (policyText) {
-            strncpy(application.POLICY, policyText, sizeof(application.POLICY) - 1);
-            application.POLICY[sizeof(application.POLICY) - 1] = '\0';
-        }
+    if (!m_options.synchronous)
+    {
+        ExecuteQuery("PRAGMA synchronous = OFF;");
     }
 
-    sqlite3_finalize(stmt);
-
-    return application;
+    // Whatever is still queued when the simulation is torn down must reach the disk
+    m_destroyEvent = ns3::Simulator::ScheduleDestroy(&Database::Flush, this);
 }
 
-WRK Database::SelectWorker(float cpu, float memory, float storage, const char *policy, bool balanced)
+void Database::Close()
 {
-    std::ostringstream oss;
-    oss << "WITH FILTERED_WORKERS AS ("
-        << "SELECT "
-        << "WORKERS.ID AS worker, "
-        << "WORKERS.POWER AS battery, "
-        << "WORKERS.INITIAL_CONSUMPTION AS initial_consumption, "
-        << "WORKERS.CURRENT_CONSUMPTION + (COUNT(APPLICATIONS.ID) * WORKERS.INITIAL_CONSUMPTION) AS current_consumption, "
-        << "WORKERS.CPU - COALESCE(SUM(APPLICATIONS.CPU), 0) AS cpu_remaining, "
-        << "WORKERS.MEMORY - COALESCE(SUM(APPLICATIONS.MEMORY), 0) AS memory_remaining, "
-        << "WORKERS.TRANSMISSION AS transmission, "
-        << "WORKERS.STORAGE - COALESCE(SUM(APPLICATIONS.STORAGE), 0) AS storage_remaining, "
-        << "COUNT(APPLICATIONS.ID) AS application_quantity "
-        << "FROM WORKERS "
-        << "LEFT JOIN WORKERS_APPLICATIONS ON WORKERS_APPLICATIONS.ID_WORKER = WORKERS.ID "
-        << "LEFT JOIN APPLICATIONS ON APPLICATIONS.ID = WORKERS_APPLICATIONS.ID_APPLICATION AND APPLICATIONS.FINISH = 2 "
-        << "GROUP BY WORKERS.ID"
-        << ") "
-        << "SELECT * FROM FILTERED_WORKERS "
-        << "WHERE "
-        << "cpu_remaining >= " << cpu << " AND "
-        << "memory_remaining >= " << memory << " AND "
-        << "storage_remaining >= " << storage << " AND "
-        << "battery > 50 "
-        << "ORDER BY ";
-
-    if (balanced)
-    {
-        oss << "application_quantity ASC, ";
+    if (!db) {
+        return;
     }
+    Flush();
+    FinalizeStatements();
 
-    if (strcmp(policy, "performance") == 0)
+    if (m_options.inMemory)
     {
-        oss << "cpu_remaining DESC ";
+        sqlite3 *file = nullptr;
+        if (sqlite3_open(m_options.path.c_str(), &file) == SQLITE_OK)
+        {
+            sqlite3_backup *backup = sqlite3_backup_init(file, "main", db, "main");
+            if (backup)
+            {
+                sqlite3_backup_step(backup, -1);
+                sqlite3_backup_finish(backup);
+            }
+        }
+        if (sqlite3_errcode(file) != SQLITE_OK)
+        {
+            std::cerr << "Erro ao salvar o banco de dados em " << m_options.path << ": " << sqlite3_errmsg(file) << std::endl;
+        }
+        sqlite3_close(file);
     }
-    else if (strcmp(policy, "storage") == 0)
+
+    sqlite3_close(db);
+    db = nullptr;
+    NS_LOG_INFO("Banco de dados fechado.");
+}
+
+Database::Row &Database::Enqueue(RowKind kind)
+{
+    if (m_rows.size() >= m_options.batchRows)
     {
-        oss << "storage_remaining DESC ";
+        Flush();
     }
-    else if (strcmp(policy, "transmission") == 0)
+    m_rows.emplace_back();
+    Row &row = m_rows.back();
+    row.kind = kind;
+    if (m_rows.size() == 1 && m_options.batchInterval > 0.0)
     {
-        oss << "transmission DESC ";
+        m_flushEvent = ns3::Simulator::Schedule(ns3::Seconds(m_options.batchInterval), &Database::Flush, this);
     }
+    return row;
+}
 
-    oss << "LIMIT 1;";
-
-    sqlite3_stmt *stmt;
-
-    //std::cout << oss.str().c_str() << std::endl;
+void Database::Flush()
+{
+    m_flushEvent.Cancel();
+    if (!db || m_rows.empty()) {
+        m_rows.clear();
+        return;
+    }
+    PrepareStatements();
 
-    WRK worker = {0};
-    if (sqlite3_prepare_v2(db, oss.str().c_str(), -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+    ExecuteQuery("BEGIN TRANSACTION;");
+    for (const Row &row : m_rows)
     {
-        worker.ID = sqlite3_column_int(stmt, 0);
-        worker.POWER = static_cast<float>(sqlite3_column_double(stmt, 1));
-        worker.INITIAL_CONSUMPTION = static_cast<float>(sqlite3_column_double(stmt, 2));
-        worker.CURRENT_CONSUMPTION = static_cast<float>(sqlite3_column_double(stmt, 3));
-        worker.CPU = static_cast<float>(sqlite3_column_double(stmt, 4));
-        worker.MEMORY = static_cast<float>(sqlite3_column_double(stmt, 5));
-        worker.TRANSMISSION = static_cast<float>(sqlite3_column_double(stmt, 6));
-        worker.STORAGE = static_cast<float>(sqlite3_column_double(stmt, 7));
-
-        std::cout << "Worker Found:\n"
-                  << "  ID: " << worker.ID << "\n"
-                  << "  Power: " << worker.POWER << "\n"
-                  << "  Initial Consumption: " << worker.INITIAL_CONSUMPTION << "\n"
-                  << "  Current Consumption: " << worker.CURRENT_CONSUMPTION << "\n"
-                  << "  CPU: " << worker.CPU << "\n"
-                  << "  Memory: " << worker.MEMORY << "\n"
-                  << "  Transmission: " << worker.TRANSMISSION << "\n"
-                  << "  Storage: " << worker.STORAGE << "\n";
+        sqlite3_stmt *stmt = m_statements[row.kind];
+        if (!stmt)
+        {
+            continue;
+        }
+        switch (row.kind)
+        {
+        case INSERT_WORKER:
+            for (int i = 0; i < 7; ++i)
+            {
+                sqlite3_bind_double(stmt, i + 1, row.value[i]);
+            }
+            sqlite3_bind_text(stmt, 8, row.text.c_str(), -1, SQLITE_STATIC);
+            break;
+        case INSERT_APPLICATION:
+            for (int i = 0; i < 5; ++i)
+            {
+                sqlite3_bind_double(stmt, i + 1, row.value[i]);
+            }
+            sqlite3_bind_text(stmt, 6, row.text.c_str(), -1, SQLITE_STATIC);
+            break;
+        case UPDATE_POWER:
+            sqlite3_bind_double(stmt, 1, row.value[0]);
+            sqlite3_bind_int(stmt, 2, row.id[0]);
+            break;
+        case INSERT_WORKER_APPLICATION:
+            sqlite3_bind_int(stmt, 1, row.id[0]);
+            sqlite3_bind_int(stmt, 2, row.id[1]);
+            sqlite3_bind_double(stmt, 3, row.value[0]);
+            break;
+        case FINISH_WORKER_APPLICATION:
+            sqlite3_bind_double(stmt, 1, row.value[0]);
+            sqlite3_bind_int(stmt, 2, row.id[0]);
+            sqlite3_bind_int(stmt, 3, row.id[1]);
+            break;
+        case UPDATE_APPLICATION_STATUS:
+            sqlite3_bind_int(stmt, 1, row.id[1]);
+            sqlite3_bind_int(stmt, 2, row.id[0]);
+            break;
+        default:
+            break;
+        }
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            std::cerr << "Erro ao executar query: " << sqlite3_errmsg(db) << std::endl;
+        }
+        sqlite3_reset(stmt);
     }
-
-    sqlite3_finalize(stmt);
-    return worker;
+    ExecuteQuery("COMMIT;");
+    m_rows.clear();
 }
 
-void Database::InsertWorkerApplication(int idWorker, int idApplication, double performedAt)
+void Database::PrepareStatements()
 {
-    std::ostringstream oss;
-    oss << "INSERT INTO WORKERS_APPLICATIONS (ID_WORKER, ID_APPLICATION, PERFORMED_AT, FINISHED_AT) "
-        << "VALUES (" << idWorker << ", " << idApplication << ", " << performedAt << ", 0);";
-
-    if (ExecuteQuery(oss.str().c_str()))
+    for (int k = 0; k < ROW_KIND_COUNT; ++k)
     {
-        std::cout << "At time " << std::to_string(performedAt).substr(0, std::to_string(performedAt).find(".") + 2) << "s: "
-              << "Inserting Worker Application into database with:\n"
-              << "  > ID Worker = " << idWorker << ";\n"
-              << "  > ID Application = " << idApplication << ";\n"
-              << "  > Performed At = " << performedAt << ";"
-              << std::endl;
+        if (!m_statements[k] && sqlite3_prepare_v2(db, g_statements[k], -1, &m_statements[k], nullptr) != SQLITE_OK)
+        {
+            std::cerr << "Erro ao preparar query: " << sqlite3_errmsg(db) << std::endl;
+            m_statements[k] = nullptr;
+        }
     }
 }
 
-void Database::RemoveWorkerApplication(int idWorker, int idApplication, double currentTime)
+void Database::FinalizeStatements()
 {
-    std::ostringstream oss;
-    oss << "UPDATE WORKERS_APPLICATIONS "
-        << "SET FINISHED_AT = " << currentTime
-        << " WHERE ID_WORKER = " << idWorker
-        << " AND ID_APPLICATION = " << idApplication;
-
-    if (ExecuteQuery(oss.str().c_str()))
+    for (int k = 0; k < ROW_KIND_COUNT; ++k)
     {
-        std::cout << "At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: "
-                  << "Removing Worker Application from database with:\n"
-                  << "  > ID Worker = " << idWorker << ";\n"
-                  << "  > ID Application = " << idApplication << ";\n"
-                  << "  > Finished At = " << currentTime << ";"
-                  << std::endl;
+        sqlite3_finalize(m_statements[k]);
+        m_statements[k] = nullptr;
     }
 }
 
-std::vector<int> Database::GetApplicationsToReallocate()
+void Database::AddNodeToDatabase(double power, double initial_consumption, double current_consumption, double cpu, double memory, double transmission, double storage, std::string node_name)
 {
-    std::vector<int> result;
+    Row &row = Enqueue(INSERT_WORKER);
+    row.value[0] = power;
+    row.value[1] = initial_consumption;
+    row.value[2] = current_consumption;
+    row.value[3] = cpu;
+    row.value[4] = memory;
+    row.value[5] = transmission;
+    row.value[6] = storage;
+    row.text = node_name;
+
+    NS_LOG_INFO("Inserting Node " << node_name << " to database with:\n"
+            << "  > Power = " << power << ";\n"
+            << "  > Initial Consumption = " << initial_consumption << ";\n"
+            << "  > Current Consumption = " << current_consumption << ";\n"
+            << "  > CPU = " << cpu << ";\n"
+            << "  > Memory = " << memory << ";\n"
+            << "  > Transmission = " << transmission << ";\n"
+            << "  > Storage = " << storage << ";\n");
+}
 
-    std::string query = "SELECT ID FROM APPLICATIONS WHERE FINISH = 3;";
+void Database::UpdateNodeResources(int workerId, double updatedPower)
+{
+    Row &row = Enqueue(UPDATE_POWER);
+    row.id[0] = workerId;
+    row.value[0] = updatedPower;
+}
 
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) == SQLITE_OK)
-    {
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            int appId = sqlite3_column_int(stmt, 0);
-            result.push_back(appId);
-        }
-        sqlite3_finalize(stmt);
-    }
+void Database::AddAppToDatabase(double currentTime, std::string policy, float start, float duration, double cpu, double memory, double storage)
+{
+    Row &row = Enqueue(INSERT_APPLICATION);
+    row.value[0] = start;
+    row.value[1] = duration;
+    row.value[2] = cpu;
+    row.value[3] = memory;
+    row.value[4] = storage;
+    row.text = policy;
+
+    NS_LOG_INFO("At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: "
+            << "Inserting Application " << policy << " to database with:\n"
+            << "  > Start = " << start << ";\n"
+            << "  > Duration = " << duration << ";\n"
+            << "  > CPU = " << cpu << ";\n"
+            << "  > Memory = " << memory << ";\n"
+            << "  > Storage = " << storage << ";\n");
+}
 
-    return result;
+void Database::InsertWorkerApplication(int idWorker, int idApplication, double performedAt)
+{
+    Row &row = Enqueue(INSERT_WORKER_APPLICATION);
+    row.id[0] = idWorker;
+    row.id[1] = idApplication;
+    row.value[0] = performedAt;
+
+    NS_LOG_INFO("At time " << std::to_string(performedAt).substr(0, std::to_string(performedAt).find(".") + 2) << "s: "
+          << "Inserting Worker Application into database with:\n"
+          << "  > ID Worker = " << idWorker << ";\n"
+          << "  > ID Application = " << idApplication << ";\n"
+          << "  > Performed At = " << performedAt << ";");
 }
 
-void Database::MarkApplicationStatus(int appId, std::string status, double currentTime)
+void Database::RemoveWorkerApplication(int idWorker, int idApplication, double currentTime)
 {
-    std::ostringstream oss;
-    oss << "UPDATE APPLICATIONS SET FINISH = " << status << " WHERE ID = " << appId << ";";
+    Row &row = Enqueue(FINISH_WORKER_APPLICATION);
+    row.id[0] = idWorker;
+    row.id[1] = idApplication;
+    row.value[0] = currentTime;
 
-    if (ExecuteQuery(oss.str()))
-    {
-        std::cout << "At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: ";
-        std::cout << "Updated Application finish status in database with:\n"
-                  << "  > ID = " << appId << "\n"
-                  << "  > FINISH = " << status << ";\n";
-    }
+    NS_LOG_INFO("At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: "
+              << "Removing Worker Application from database with:\n"
+              << "  > ID Worker = " << idWorker << ";\n"
+              << "  > ID Application = " << idApplication << ";\n"
+              << "  > Finished At = " << currentTime << ";");
+}
+
+void Database::MarkApplicationStatus(int appId, int status, double currentTime)
+{
+    Row &row = Enqueue(UPDATE_APPLICATION_STATUS);
+    row.id[0] = appId;
+    row.id[1] = status;
+
+    NS_LOG_INFO("At time " << std::to_string(currentTime).substr(0, std::to_string(currentTime).find(".") + 2) << "s: "
+              << "Updated Application finish status in database with:\n"
+              << "  > ID = " << appId << "\n"
+              << "  > FINISH = " << status << ";");
 }
 
 bool Database::ExecuteQuery(const std::string &query) {
+    if (!db) {
+        return false;
+    }
     char *errMsg = nullptr;
     if (sqlite3_exec(db, query.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
         std::cerr << "Erro ao executar query: " << errMsg << std::endl;
@@ -313,6 +340,9 @@ void Database::CreateAllTables()
 
 void Database::DropAllTables()
 {
+    m_rows.clear();
+    FinalizeStatements();
+
     const char sql[] =
         "DROP TABLE IF EXISTS WORKERS;"
         "DROP TABLE IF EXISTS APPLICATIONS;"
@@ -320,28 +350,10 @@ void Database::DropAllTables()
 
     if (ExecuteQuery(sql))
     {
-        std::cout << "All database tables dropped successfully." << std::endl;
+        NS_LOG_INFO("All database tables dropped successfully.");
     }
     else
     {
         std::cerr << "Failed to drop database tables." << std::endl;
     }
 }
-
-double Database::HibridPolicy()
-{
-    double avgPower = 0.0;
-
-    const char *sql = "SELECT AVG(POWER) FROM WORKERS;";
-
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            avgPower = sqlite3_column_double(stmt, 0);
-        }
-    }
-
-    sqlite3_finalize(stmt);
-
-    return avgPower;
-}
\ No newline at end of file
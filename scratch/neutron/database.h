@@ -3,28 +3,67 @@
 
 #include <sqlite3.h>
 #include <string>
+#include <vector>
+#include "ns3/event-id.h"
 #include "structs.h"
 
+struct DatabaseOptions
+{
+    std::string path = "scratch/database.db";
+    bool inMemory = false;      // keep the database in RAM and back it up to path on Close
+    bool wal = false;           // PRAGMA journal_mode = WAL
+    bool synchronous = true;    // PRAGMA synchronous = OFF when false
+    uint32_t batchRows = 10000; // flush when this many rows are queued
+    double batchInterval = 3600.0; // flush at most this many simulated seconds after the first queued row
+};
+
 class Database {
 public:
     Database();
     ~Database();
+    void Open(const DatabaseOptions &options);
+    void Close();
+    void Flush();
     bool ExecuteQuery(const std::string &query);
     void AddNodeToDatabase(double power, double initial_consumption, double current_consumption, double cpu, double memory, double transmission, double storage, std::string node_name);
     void UpdateNodeResources(int workerId, double updatedPower);
     void AddAppToDatabase(double currentTime, std::string policy, float start, float duration, double cpu, double memory, double storage);
     void InsertWorkerApplication(int idWorker, int idApplication, double performedAt);
     void RemoveWorkerApplication(int idWorker, int idApplication, double currentTime);
-    void MarkApplicationStatus(int appId, std::string status, double currentTime);
-    double HibridPolicy();
+    void MarkApplicationStatus(int appId, int status, double currentTime);
     void DropAllTables();
     void CreateAllTables();
-    std::vector<int> GetApplicationsToReallocate();
-    APP SelectApplicationById(int id);
-    WRK SelectWorker(float cpu, float memory, float storage, const char *policy, bool balanced);
 
 private:
+    enum RowKind
+    {
+        INSERT_WORKER = 0,
+        INSERT_APPLICATION,
+        UPDATE_POWER,
+        INSERT_WORKER_APPLICATION,
+        FINISH_WORKER_APPLICATION,
+        UPDATE_APPLICATION_STATUS,
+        ROW_KIND_COUNT
+    };
+
+    struct Row
+    {
+        RowKind kind;
+        int id[2];
+        double value[7];
+        std::string text;
+    };
+
+    Row &Enqueue(RowKind kind);
+    void PrepareStatements();
+    void FinalizeStatements();
+
     sqlite3 *db;
+    DatabaseOptions m_options;
+    std::vector<Row> m_rows;
+    sqlite3_stmt *m_statements[ROW_KIND_COUNT];
+    ns3::EventId m_flushEvent;
+    ns3::EventId m_destroyEvent;
 };
 
 #endif // DATABASE_H
@@ -0,0 +1,157 @@
+#include "ns3/core-module.h"
+#include "decision-log.h"
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace ns3;
+using namespace std;
+
+// Prints a decision log written by main --decisions as CSV:
+//
+//   time,event,app,worker,reason
+//
+// where arrivals list their policy as the reason.  With --against, compares the placement decisions of two logs instead,
+// matching the n-th attempt for an application in one log with the n-th
+// attempt for it in the other, and prints those that chose another worker:
+//
+//   app,attempt,time_a,worker_a,time_b,worker_b
+
+struct Decision
+{
+  double time;
+  int32_t worker;
+};
+
+static const char *ReasonName(uint8_t reason)
+{
+  static const char *names[] = {"arrival", "retry", "resume"};
+  return reason <= Controller::RESUME ? names[reason] : "unknown";
+}
+
+static bool Load(const string &path, map<int32_t, vector<Decision>> &decisions)
+{
+  DecisionLogReader reader;
+  if (!reader.Open(path))
+  {
+    return false;
+  }
+  DecisionLog::Record record;
+  while (reader.Next(record))
+  {
+    if (record.type == DecisionLog::DECISION)
+    {
+      decisions[record.app].push_back(Decision{TimeStep(record.time).GetSeconds(), record.worker});
+    }
+  }
+  return true;
+}
+
+static int Print(const string &path)
+{
+  DecisionLogReader reader;
+  if (!reader.Open(path))
+  {
+    cerr << "Could not read decision log " << path << endl;
+    return 1;
+  }
+  cout << "time,event,app,worker,reason" << endl;
+  cout << setprecision(12);
+  DecisionLog::Record record;
+  while (reader.Next(record))
+  {
+    cout << TimeStep(record.time).GetSeconds() << ',';
+    if (record.type == DecisionLog::DECISION)
+    {
+      cout << "decision," << record.app << ',' << record.worker << ',' << ReasonName(record.reason) << '\n';
+    }
+    else
+    {
+      cout << "arrival," << record.app << ",0," << record.spec.POLICY << '\n';
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  string input = "";
+  string against = "";
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("input", "Decision log written by --decisions", input);
+  cmd.AddValue("against", "Second decision log to compare the first with", against);
+  cmd.Parse(argc, argv);
+
+  if (input.empty())
+  {
+    cmd.PrintHelp(cout);
+    return 0;
+  }
+  if (against.empty())
+  {
+    return Print(input);
+  }
+
+  map<int32_t, vector<Decision>> a;
+  map<int32_t, vector<Decision>> b;
+  if (!Load(input, a) || !Load(against, b))
+  {
+    cerr << "Could not read the decision logs" << endl;
+    return 1;
+  }
+  uint64_t compared = 0;
+  uint64_t differing = 0;
+  cout << "app,attempt,time_a,worker_a,time_b,worker_b" << endl;
+  cout << setprecision(12);
+  for (const auto &entry : a)
+  {
+    auto other = b.find(entry.first);
+    size_t count = other == b.end() ? 0 : other->second.size();
+    for (size_t n = 0; n < max(entry.second.size(), count); ++n)
+    {
+      compared++;
+      bool inA = n < entry.second.size();
+      bool inB = n < count;
+      if (inA && inB && entry.second[n].worker == other->second[n].worker)
+      {
+        continue;
+      }
+      differing++;
+      cout << entry.first << ',' << n + 1 << ',';
+      if (inA)
+      {
+        cout << entry.second[n].time << ',' << entry.second[n].worker << ',';
+      }
+      else
+      {
+        cout << ",,";
+      }
+      if (inB)
+      {
+        cout << other->second[n].time << ',' << other->second[n].worker;
+      }
+      else
+      {
+        cout << ',';
+      }
+      cout << '\n';
+    }
+  }
+  for (const auto &entry : b)
+  {
+    if (a.find(entry.first) == a.end())
+    {
+      for (size_t n = 0; n < entry.second.size(); ++n)
+      {
+        compared++;
+        differing++;
+        cout << entry.first << ',' << n + 1 << ",,," << entry.second[n].time << ',' << entry.second[n].worker << '\n';
+      }
+    }
+  }
+  cerr << differing << " of " << compared << " placement attempts differ" << endl;
+  return 0;
+}
@@ -0,0 +1,233 @@
+#include "decision-log.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("DecisionLog");
+
+static const std::size_t BUFFERED_BYTES = 1 << 20;
+static const char DECISION_MAGIC[4] = {'N', 'D', 'E', 'C'};
+static const uint32_t DECISION_VERSION = 1;
+
+DecisionLog::DecisionLog() {}
+
+DecisionLog::~DecisionLog()
+{
+    Close();
+}
+
+bool DecisionLog::Open(const std::string &path)
+{
+    m_file.open(path, std::ios::binary | std::ios::out);
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+    m_buffer.reserve(BUFFERED_BYTES + 64);
+    m_file.write(DECISION_MAGIC, sizeof(DECISION_MAGIC));
+    m_file.write(reinterpret_cast<const char *>(&DECISION_VERSION), sizeof(DECISION_VERSION));
+    return true;
+}
+
+void DecisionLog::Connect(Ptr<Controller> controller)
+{
+    m_controller = controller;
+    controller->TraceConnectWithoutContext("AppAdded", MakeCallback(&DecisionLog::AppAdded, this));
+    controller->TraceConnectWithoutContext("PlacementDecided", MakeCallback(&DecisionLog::PlacementDecided, this));
+}
+
+template <typename T>
+void DecisionLog::Put(T value)
+{
+    m_buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void DecisionLog::AppAdded(int appId)
+{
+    const APP &application = m_controller->GetApp(appId);
+    uint8_t length = std::min<std::size_t>(strlen(application.POLICY), 255);
+    Put<uint8_t>(ARRIVAL);
+    Put<int64_t>(Simulator::Now().GetTimeStep());
+    Put<int32_t>(appId);
+    Put<float>(application.START);
+    Put<float>(application.DURATION);
+    Put<float>(application.CPU);
+    Put<float>(application.MEMORY);
+    Put<float>(application.STORAGE);
+    Put<uint8_t>(length);
+    m_buffer.append(application.POLICY, length);
+    if (m_buffer.size() >= BUFFERED_BYTES)
+    {
+        Flush();
+    }
+}
+
+void DecisionLog::PlacementDecided(int appId, int workerId, uint8_t reason)
+{
+    Put<uint8_t>(DECISION);
+    Put<int64_t>(Simulator::Now().GetTimeStep());
+    Put<int32_t>(appId);
+    Put<int32_t>(workerId);
+    Put<uint8_t>(reason);
+    if (m_buffer.size() >= BUFFERED_BYTES)
+    {
+        Flush();
+    }
+}
+
+void DecisionLog::Flush()
+{
+    if (m_file.is_open())
+    {
+        m_file.write(m_buffer.data(), m_buffer.size());
+    }
+    m_buffer.clear();
+}
+
+void DecisionLog::Close()
+{
+    Flush();
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    m_controller = nullptr;
+}
+
+bool DecisionLogReader::Open(const std::string &path)
+{
+    m_file.open(path, std::ios::binary | std::ios::in);
+    char magic[4];
+    uint32_t version = 0;
+    m_file.read(magic, sizeof(magic));
+    m_file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    return m_file.good() && std::memcmp(magic, DECISION_MAGIC, sizeof(magic)) == 0 && version == DECISION_VERSION;
+}
+
+template <typename T>
+bool DecisionLogReader::Get(T &value)
+{
+    return static_cast<bool>(m_file.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+bool DecisionLogReader::Next(DecisionLog::Record &record)
+{
+    if (!Get(record.type) || !Get(record.time) || !Get(record.app))
+    {
+        return false;
+    }
+    if (record.type == DecisionLog::DECISION)
+    {
+        return Get(record.worker) && Get(record.reason);
+    }
+    uint8_t length = 0;
+    record.worker = 0;
+    record.reason = 0;
+    if (!Get(record.spec.START) || !Get(record.spec.DURATION) || !Get(record.spec.CPU) ||
+        !Get(record.spec.MEMORY) || !Get(record.spec.STORAGE) || !Get(length))
+    {
+        return false;
+    }
+    record.spec.POLICY.resize(length);
+    return length == 0 || static_cast<bool>(m_file.read(&record.spec.POLICY[0], length));
+}
+
+DecisionReplay::DecisionReplay()
+    : m_next(0),
+      m_misses(0)
+{
+}
+
+bool DecisionReplay::Open(const std::string &path, Ptr<Controller> controller)
+{
+    DecisionLogReader reader;
+    if (!reader.Open(path))
+    {
+        return false;
+    }
+    m_controller = controller;
+    std::unordered_map<int32_t, std::size_t> arrivalIndex;
+    DecisionLog::Record record;
+    while (reader.Next(record))
+    {
+        if (record.type == DecisionLog::ARRIVAL)
+        {
+            arrivalIndex[record.app] = m_arrivals.size();
+            m_arrivals.push_back(Arrival{record.time, -1, record.app, record.spec});
+            continue;
+        }
+        std::vector<int32_t> &workers = m_decisions[record.app].workers;
+        if (workers.empty())
+        {
+            // The first attempt is made when the application arrives
+            auto it = arrivalIndex.find(record.app);
+            if (it != arrivalIndex.end())
+            {
+                m_arrivals[it->second].arrives = record.time;
+            }
+        }
+        workers.push_back(record.worker);
+    }
+    m_controller->SetReplay(MakeCallback(&DecisionReplay::NextWorker, this));
+    return true;
+}
+
+void DecisionReplay::Start()
+{
+    if (m_next < m_arrivals.size())
+    {
+        Simulator::Schedule(TimeStep(m_arrivals[m_next].registered) - Simulator::Now(), &DecisionReplay::Register,
+                            this);
+    }
+}
+
+void DecisionReplay::Register()
+{
+    // Everything registered at the same instant is handled in one event, like the arrival windows
+    int64_t now = Simulator::Now().GetTimeStep();
+    while (m_next < m_arrivals.size() && m_arrivals[m_next].registered <= now)
+    {
+        const Arrival &arrival = m_arrivals[m_next++];
+        const APP_SPEC &spec = arrival.spec;
+        int appId = m_controller->AddApp(spec.POLICY, spec.START, spec.DURATION, spec.CPU, spec.MEMORY,
+                                         spec.STORAGE);
+        if (appId != arrival.app)
+        {
+            NS_LOG_WARN("Recorded application " << arrival.app << " was registered as " << appId);
+        }
+        if (arrival.arrives >= 0)
+        {
+            Simulator::Schedule(TimeStep(arrival.arrives) - Simulator::Now(), &Controller::AllocateApp,
+                                m_controller, appId);
+        }
+    }
+    Start();
+}
+
+int DecisionReplay::NextWorker(int appId)
+{
+    auto it = m_decisions.find(appId);
+    if (it == m_decisions.end() || it->second.used >= it->second.workers.size())
+    {
+        m_misses++;
+        return -1;
+    }
+    return it->second.workers[it->second.used++];
+}
+
+uint64_t DecisionReplay::GetGenerated() const
+{
+    return m_next;
+}
+
+uint64_t DecisionReplay::GetMisses() const
+{
+    return m_misses;
+}
+
+} // namespace ns3
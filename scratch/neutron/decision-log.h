@@ -0,0 +1,133 @@
+#ifndef DECISION_LOG_H
+#define DECISION_LOG_H
+
+#include "controller.h"
+#include "workload.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Binary log of the applications a controller registered and of every
+ * placement decision it made.
+ *
+ * An ARRIVAL record is written when an application is registered and
+ * carries everything AddApp needs to register it again.  A DECISION record
+ * is written for every placement attempt with the worker chosen (0 when no
+ * worker could take the application) and why the attempt was made.  Times
+ * are kept in simulator time steps so a replay lands on the same instants.
+ *
+ * File layout (native byte order): magic "NDEC" and a uint32 version,
+ * followed by records that start with their uint8 type.  An ARRIVAL holds
+ * int64 time, int32 app, float start, duration, cpu, memory and storage,
+ * and the policy name as a uint8 length and its characters.  A DECISION
+ * holds int64 time, int32 app, int32 worker and uint8 reason.
+ */
+class DecisionLog
+{
+public:
+  enum Type : uint8_t
+  {
+    ARRIVAL = 1,
+    DECISION
+  };
+
+  struct Record
+  {
+    uint8_t type;
+    int64_t time;
+    int32_t app;
+    int32_t worker;
+    uint8_t reason;
+    APP_SPEC spec; // ARRIVAL only
+  };
+
+  DecisionLog ();
+  ~DecisionLog ();
+
+  bool Open (const std::string &path);
+  void Connect (Ptr<Controller> controller);
+  void Flush ();
+  void Close ();
+
+private:
+  template <typename T> void Put (T value);
+  void AppAdded (int appId);
+  void PlacementDecided (int appId, int workerId, uint8_t reason);
+
+  std::ofstream m_file;
+  std::string m_buffer;
+  Ptr<Controller> m_controller;
+};
+
+/** Reads back the records of a DecisionLog file, in the order they were written. */
+class DecisionLogReader
+{
+public:
+  bool Open (const std::string &path);
+  /** Returns false at the end of the file or on a truncated record. */
+  bool Next (DecisionLog::Record &record);
+
+private:
+  template <typename T> bool Get (T &value);
+
+  std::ifstream m_file;
+};
+
+/**
+ * Drives a controller from a DecisionLog instead of the scenario and the
+ * placement policies.
+ *
+ * Applications are registered at the times they were registered in the
+ * recorded run and arrive at the time of their first recorded decision.
+ * Every placement attempt then takes the next recorded worker for that
+ * application rather than running the policy, so the run repeats the
+ * recorded one while leaving the placement cost out.  An attempt with no
+ * recorded decision left falls back to the policy and is counted as a
+ * miss; a non-zero count means the runs diverged.
+ *
+ * The whole log is loaded in memory when the replay starts.
+ */
+class DecisionReplay
+{
+public:
+  DecisionReplay ();
+
+  bool Open (const std::string &path, Ptr<Controller> controller);
+  void Start ();
+  uint64_t GetGenerated () const;
+  uint64_t GetMisses () const;
+
+private:
+  struct Arrival
+  {
+    int64_t registered;
+    int64_t arrives;
+    int32_t app;
+    APP_SPEC spec;
+  };
+
+  struct Decisions
+  {
+    std::vector<int32_t> workers;
+    std::size_t used = 0;
+  };
+
+  void Register ();
+  int NextWorker (int appId);
+
+  Ptr<Controller> m_controller;
+  std::vector<Arrival> m_arrivals;
+  std::size_t m_next;
+  std::unordered_map<int32_t, Decisions> m_decisions;
+  uint64_t m_misses;
+};
+
+} // namespace ns3
+
+#endif // DECISION_LOG_H
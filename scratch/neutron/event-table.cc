@@ -0,0 +1,88 @@
+#include "event-table.h"
+
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+EventTable::EventTable()
+    : m_pending(0)
+{
+}
+
+EventTable::Slot &EventTable::Get(uint32_t id)
+{
+    if (id >= m_slots.size())
+    {
+        m_slots.resize(id + 1, Slot{EventId(), 0, false});
+    }
+    return m_slots[id];
+}
+
+// Cancels whatever the slot held and returns the generation the next event must carry
+uint32_t EventTable::Arm(uint32_t id)
+{
+    Cancel(id);
+    Slot &slot = Get(id);
+    slot.armed = true;
+    m_pending++;
+    return slot.generation;
+}
+
+void EventTable::Set(uint32_t id, const EventId &event)
+{
+    Get(id).event = event;
+}
+
+bool EventTable::IsCurrent(uint32_t id, uint32_t generation) const
+{
+    return id < m_slots.size() && m_slots[id].armed && m_slots[id].generation == generation;
+}
+
+bool EventTable::IsPending(uint32_t id) const
+{
+    return id < m_slots.size() && m_slots[id].armed;
+}
+
+void EventTable::Cancel(uint32_t id)
+{
+    if (id >= m_slots.size())
+    {
+        return;
+    }
+    Slot &slot = m_slots[id];
+    if (slot.armed)
+    {
+        Simulator::Cancel(slot.event);
+    }
+    Release(id);
+}
+
+void EventTable::CancelAll(const std::vector<int> &ids)
+{
+    for (int id : ids)
+    {
+        Cancel(id);
+    }
+}
+
+// Forgets the slot's event without cancelling it, used once the event has run
+void EventTable::Release(uint32_t id)
+{
+    if (id >= m_slots.size())
+    {
+        return;
+    }
+    Slot &slot = m_slots[id];
+    if (slot.armed)
+    {
+        m_pending--;
+    }
+    slot.event = EventId();
+    slot.generation++;
+    slot.armed = false;
+}
+
+std::size_t EventTable::GetSize() const { return m_slots.size(); }
+std::size_t EventTable::GetPendingCount() const { return m_pending; }
+
+} // namespace ns3
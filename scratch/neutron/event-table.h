@@ -0,0 +1,52 @@
+#ifndef EVENT_TABLE_H
+#define EVENT_TABLE_H
+
+#include "ns3/event-id.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Pending events keyed by a dense integer id (application or worker id).
+ *
+ * The table grows on demand, so the number of ids is only bounded by memory.
+ * Every slot carries a generation counter that is bumped whenever the slot
+ * is re-armed or cancelled; callbacks scheduled with the generation returned
+ * by Arm can check IsCurrent and ignore themselves if the slot moved on.
+ */
+class EventTable
+{
+public:
+  EventTable ();
+
+  uint32_t Arm (uint32_t id);
+  void Set (uint32_t id, const EventId &event);
+  bool IsCurrent (uint32_t id, uint32_t generation) const;
+  bool IsPending (uint32_t id) const;
+
+  void Cancel (uint32_t id);
+  void CancelAll (const std::vector<int> &ids);
+  void Release (uint32_t id);
+
+  std::size_t GetSize () const;
+  std::size_t GetPendingCount () const;
+
+private:
+  struct Slot
+  {
+    EventId event;
+    uint32_t generation;
+    bool armed;
+  };
+
+  Slot &Get (uint32_t id);
+
+  std::vector<Slot> m_slots;
+  std::size_t m_pending;
+};
+
+} // namespace ns3
+
+#endif // EVENT_TABLE_H
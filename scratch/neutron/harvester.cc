@@ -0,0 +1,181 @@
+#include "harvester.h"
+
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(BatteryHarvester);
+NS_OBJECT_ENSURE_REGISTERED(ConstantHarvester);
+NS_OBJECT_ENSURE_REGISTERED(SolarHarvester);
+
+TypeId
+BatteryHarvester::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::BatteryHarvester")
+        .SetParent<energy::EnergyHarvester>()
+        .SetGroupName("Energy");
+    return tid;
+}
+
+Ptr<BatteryHarvester>
+BatteryHarvester::Create(const std::string &name)
+{
+    if (name == "constant")
+    {
+        return CreateObject<ConstantHarvester>();
+    }
+    if (name == "solar")
+    {
+        return CreateObject<SolarHarvester>();
+    }
+    return nullptr;
+}
+
+double BatteryHarvester::DoGetPower() const
+{
+    return GetRate(Simulator::Now().GetSeconds());
+}
+
+TypeId
+ConstantHarvester::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::ConstantHarvester")
+        .SetParent<BatteryHarvester>()
+        .SetGroupName("Energy")
+        .AddConstructor<ConstantHarvester>()
+        .AddAttribute("Rate",
+                      "Battery percentage harvested per second.",
+                      DoubleValue(0.001),
+                      MakeDoubleAccessor(&ConstantHarvester::m_rate),
+                      MakeDoubleChecker<double>(0.0));
+    return tid;
+}
+
+ConstantHarvester::ConstantHarvester()
+    : m_rate(0.001)
+{
+}
+
+double ConstantHarvester::GetRate(double) const { return m_rate; }
+double ConstantHarvester::GetEnergy(double from, double to) const { return m_rate * (to - from); }
+double ConstantHarvester::GetPeriod() const { return 0.0; }
+
+double ConstantHarvester::GetNextBreakpoint(double, double) const
+{
+    return std::numeric_limits<double>::infinity();
+}
+
+TypeId
+SolarHarvester::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::SolarHarvester")
+        .SetParent<BatteryHarvester>()
+        .SetGroupName("Energy")
+        .AddConstructor<SolarHarvester>()
+        .AddAttribute("PeakRate",
+                      "Battery percentage harvested per second at solar noon.",
+                      DoubleValue(0.004),
+                      MakeDoubleAccessor(&SolarHarvester::m_peakRate),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("Sunrise",
+                      "Time of day the panel starts harvesting; the day must end after sunset.",
+                      TimeValue(Hours(6)),
+                      MakeTimeAccessor(&SolarHarvester::m_sunrise),
+                      MakeTimeChecker(Time(0)))
+        .AddAttribute("Daylight",
+                      "How long the panel harvests each day.",
+                      TimeValue(Hours(12)),
+                      MakeTimeAccessor(&SolarHarvester::m_daylight),
+                      MakeTimeChecker(Time(0)))
+        .AddAttribute("Period",
+                      "Length of a day; simulation time 0 is midnight.",
+                      TimeValue(Hours(24)),
+                      MakeTimeAccessor(&SolarHarvester::m_period),
+                      MakeTimeChecker(Seconds(1)));
+    return tid;
+}
+
+SolarHarvester::SolarHarvester()
+    : m_peakRate(0.004),
+      m_sunrise(Hours(6)),
+      m_daylight(Hours(12)),
+      m_period(Hours(24))
+{
+}
+
+double SolarHarvester::GetPeriod() const { return m_period.GetSeconds(); }
+
+double SolarHarvester::GetRate(double t) const
+{
+    double period = m_period.GetSeconds();
+    double daylight = std::min(m_daylight.GetSeconds(), period);
+    double phase = t - std::floor(t / period) * period - m_sunrise.GetSeconds();
+    if (daylight <= 0.0 || phase <= 0.0 || phase >= daylight)
+    {
+        return 0.0;
+    }
+    return m_peakRate * std::sin(M_PI * phase / daylight);
+}
+
+// Energy harvested since time 0, so any interval costs two evaluations however long it is
+double SolarHarvester::Cumulative(double t) const
+{
+    double period = m_period.GetSeconds();
+    double daylight = std::min(m_daylight.GetSeconds(), period);
+    double day = m_peakRate * 2.0 * daylight / M_PI;
+    double cycles = std::floor(t / period);
+    double phase = t - cycles * period - m_sunrise.GetSeconds();
+    double partial = 0.0;
+    if (phase >= daylight)
+    {
+        partial = day;
+    }
+    else if (phase > 0.0)
+    {
+        partial = m_peakRate * daylight / M_PI * (1.0 - std::cos(M_PI * phase / daylight));
+    }
+    return cycles * day + partial;
+}
+
+double SolarHarvester::GetEnergy(double from, double to) const
+{
+    return Cumulative(to) - Cumulative(from);
+}
+
+double SolarHarvester::GetNextBreakpoint(double t, double consumption) const
+{
+    double period = m_period.GetSeconds();
+    double daylight = std::min(m_daylight.GetSeconds(), period);
+    if (m_peakRate <= 0.0 || daylight <= 0.0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    double sunrise = m_sunrise.GetSeconds();
+    // Sunrise and sunset, plus the two points where the sine meets the drain
+    double phases[4] = {sunrise, sunrise + daylight, sunrise + daylight, sunrise + daylight};
+    if (consumption > 0.0 && consumption < m_peakRate)
+    {
+        double rising = std::asin(consumption / m_peakRate) * daylight / M_PI;
+        phases[1] = sunrise + rising;
+        phases[2] = sunrise + daylight - rising;
+    }
+    double base = std::floor(t / period) * period;
+    for (int cycle = 0; cycle < 3; ++cycle, base += period)
+    {
+        for (double phase : phases)
+        {
+            if (base + phase > t)
+            {
+                return base + phase;
+            }
+        }
+    }
+    return t + period;
+}
+
+} // namespace ns3
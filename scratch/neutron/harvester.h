@@ -0,0 +1,93 @@
+#ifndef HARVESTER_H
+#define HARVESTER_H
+
+#include "ns3/energy-harvester.h"
+#include "ns3/nstime.h"
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * Energy harvester that recharges a CustomNode battery.
+ *
+ * Rates and energies are in battery percentage (per second), the unit
+ * CustomNode uses for its power and consumption, so GetPower() reports the
+ * percentage per second being harvested now.
+ *
+ * The node never polls a harvester.  It asks for the energy harvested over
+ * an interval and for the next breakpoint, the first time after t at which
+ * the harvest rate may cross a given drain.  Between two breakpoints the
+ * battery either only charges or only drains, which lets the node find the
+ * exact time it crosses a level and schedule a single event for it.
+ */
+class BatteryHarvester : public energy::EnergyHarvester
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * Creates the harvester registered under a command line name ("constant"
+   * or "solar").  Returns 0 for any other name.
+   */
+  static Ptr<BatteryHarvester> Create (const std::string &name);
+
+  /** Harvest rate at time t (seconds). */
+  virtual double GetRate (double t) const = 0;
+  /** Energy harvested between from and to (seconds). */
+  virtual double GetEnergy (double from, double to) const = 0;
+  /**
+   * First time after t at which the harvest rate may cross consumption.
+   * Infinity means the rate stays constant from t on.
+   */
+  virtual double GetNextBreakpoint (double t, double consumption) const = 0;
+  /** Length of the harvest cycle in seconds, or 0 if it does not repeat. */
+  virtual double GetPeriod () const = 0;
+
+private:
+  double DoGetPower () const override;
+};
+
+/** Harvests at the same rate all the time, like a trickle charger. */
+class ConstantHarvester : public BatteryHarvester
+{
+public:
+  static TypeId GetTypeId (void);
+  ConstantHarvester ();
+
+  double GetRate (double t) const override;
+  double GetEnergy (double from, double to) const override;
+  double GetNextBreakpoint (double t, double consumption) const override;
+  double GetPeriod () const override;
+
+private:
+  double m_rate;
+};
+
+/**
+ * Solar panel with a diurnal profile: nothing at night and a half sine
+ * between sunrise and sunset that peaks at PeakRate at solar noon.
+ */
+class SolarHarvester : public BatteryHarvester
+{
+public:
+  static TypeId GetTypeId (void);
+  SolarHarvester ();
+
+  double GetRate (double t) const override;
+  double GetEnergy (double from, double to) const override;
+  double GetNextBreakpoint (double t, double consumption) const override;
+  double GetPeriod () const override;
+
+private:
+  double Cumulative (double t) const;
+
+  double m_peakRate;
+  Time m_sunrise;
+  Time m_daylight;
+  Time m_period;
+};
+
+} // namespace ns3
+
+#endif // HARVESTER_H
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include "ns3/core-module.h"
 #include "ns3/sixlowpan-module.h"
@@ -12,14 +14,32 @@
 #include "ns3/application.h"
 #include "ns3/random-walk-2d-mobility-model.h"
 #include <yaml-cpp/yaml.h>
+#include "broker.h"
 #include "controller.h"
 #include "custom-node.h"
+#include "decision-log.h"
+#include "harvester.h"
+#include "network-builder.h"
+#include "trace-recorder.h"
+#include "utilization-sampler.h"
+#include "workload.h"
 
 using namespace ns3;
 using namespace std;
 
 NS_LOG_COMPONENT_DEFINE("POSITRON");
 
+// Nearest-rank percentile of already sorted samples
+static double Percentile(const vector<double> &sorted, double p)
+{
+  if (sorted.empty())
+  {
+    return 0.0;
+  }
+  size_t rank = static_cast<size_t>(ceil(p / 100.0 * sorted.size()));
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -27,8 +47,36 @@ int main(int argc, char *argv[])
   bool tracing = false;
   bool balanced = false;
   bool powerless = true;
+  bool audit = true;
+  DatabaseOptions dbOptions;
+  string inputFile = "./scratch/input.yaml";
+  string summaryFile = "";
+  string traceFile = "";
+  string traceFormat = "csv";
+  double window = 3600.0;
+  double arrivalRate = 0.0;
+  uint64_t arrivalCount = 0;
   uint32_t loss = 20;
   uint32_t seed = 42;
+  uint32_t reallocationCap = 64;
+  bool lookahead = false;
+  bool migrate = false;
+  double checkpointInterval = 60.0;
+  bool controlPlane = false;
+  double heartbeat = 60.0;
+  uint32_t batchSize = 8;
+  double batchDelay = 0.05;
+  double controlEnergy = 0.0;
+  string latencyFile = "";
+  string networkName = "lrwpan";
+  uint32_t regions = 1;
+  double forwardDelay = 0.01;
+  string harvesterName = "none";
+  double rechargeThreshold = 60.0;
+  string samplesFile = "";
+  double sampleInterval = 60.0;
+  string decisionFile = "";
+  string replayFile = "";
 
   CommandLine cmd(__FILE__);
   cmd.AddValue("logging", "Tell control applications to logging if true", logging);
@@ -37,22 +85,88 @@ int main(int argc, char *argv[])
   cmd.AddValue("powerless", "Set simulation scenario with battery loss", powerless);
   cmd.AddValue("loss", "Set simulation battery loss percentage", loss);
   cmd.AddValue("seed", "Set seed as an input parameter", seed);
+  cmd.AddValue("reallocationCap", "Maximum pending applications retried per released worker (0 = no limit)", reallocationCap);
+  cmd.AddValue("lookahead", "Avoid workers whose battery would run out before the application finishes", lookahead);
+  cmd.AddValue("migrate", "Resume preempted applications from their last checkpoint instead of restarting them", migrate);
+  cmd.AddValue("checkpointInterval", "Seconds between checkpoints in migration mode (0 = continuous)", checkpointInterval);
+  cmd.AddValue("network", "Packet-level network to build: lrwpan or none", networkName);
+  cmd.AddValue("regions", "Split the workers among this many regional controllers under a broker", regions);
+  cmd.AddValue("forwardDelay", "Seconds each broker-region message takes in the hierarchical mode", forwardDelay);
+  cmd.AddValue("controlPlane", "Send placement commands and heartbeats over the 6LoWPAN network", controlPlane);
+  cmd.AddValue("heartbeat", "Seconds between worker heartbeats (0 = none)", heartbeat);
+  cmd.AddValue("batchSize", "Most placement commands per control datagram", batchSize);
+  cmd.AddValue("batchDelay", "Seconds a placement command waits for others to share its datagram", batchDelay);
+  cmd.AddValue("controlEnergy", "Battery percentage a worker spends per control byte", controlEnergy);
+  cmd.AddValue("harvester", "Energy harvester on every worker: none, constant or solar", harvesterName);
+  cmd.AddValue("rechargeThreshold", "Battery level a harvesting worker needs to take applications again", rechargeThreshold);
+  cmd.AddValue("latencies", "Write every placement latency (s) to this file", latencyFile);
+  cmd.AddValue("input", "Scenario YAML file", inputFile);
+  cmd.AddValue("database", "SQLite database file", dbOptions.path);
+  cmd.AddValue("summary", "Write run counters as CSV to this file", summaryFile);
+  cmd.AddValue("window", "Seconds of arrivals registered and scheduled ahead of time", window);
+  cmd.AddValue("arrivalRate", "Synthesize Poisson arrivals at this rate (apps/s) from the input's application mix", arrivalRate);
+  cmd.AddValue("arrivalCount", "Number of synthesized applications", arrivalCount);
+  cmd.AddValue("trace", "Write controller events to this file", traceFile);
+  cmd.AddValue("samples", "Write per-worker utilization and battery samples to this binary file", samplesFile);
+  cmd.AddValue("sampleInterval", "Seconds between utilization samples", sampleInterval);
+  cmd.AddValue("decisions", "Record arrivals and placement decisions to this binary file", decisionFile);
+  cmd.AddValue("replay", "Replay the arrivals and placement decisions recorded in this file", replayFile);
+  cmd.AddValue("traceFormat", "Format of the trace file: csv or binary", traceFormat);
+  cmd.AddValue("audit", "Record placement history in the SQLite database", audit);
+  cmd.AddValue("dbInMemory", "Keep the database in memory and save it to disk at the end", dbOptions.inMemory);
+  cmd.AddValue("dbWal", "Use write-ahead logging for the database journal", dbOptions.wal);
+  cmd.AddValue("dbSync", "Wait for the database to reach the disk on every commit", dbOptions.synchronous);
+  cmd.AddValue("dbBatchRows", "Number of queued database rows that triggers a flush", dbOptions.batchRows);
+  cmd.AddValue("dbBatchInterval", "Simulated seconds a queued database row may wait before a flush", dbOptions.batchInterval);
 
   cmd.Parse(argc, argv);
 
+  NetworkMode network;
+  if (!ParseNetworkMode(networkName, network))
+  {
+    NS_FATAL_ERROR("Unknown network " << networkName << ", use lrwpan or none");
+  }
+  if (controlPlane && network == NETWORK_NONE)
+  {
+    NS_FATAL_ERROR("--controlPlane needs --network=lrwpan");
+  }
+  regions = max(regions, 1u);
+  if (regions > 1 && (controlPlane || !traceFile.empty()))
+  {
+    NS_FATAL_ERROR("--regions > 1 does not support --controlPlane or --trace yet");
+  }
+  if (regions > 1 && (!decisionFile.empty() || !replayFile.empty()))
+  {
+    NS_FATAL_ERROR("--decisions and --replay need a single region");
+  }
+  if (!samplesFile.empty() && sampleInterval <= 0.0)
+  {
+    NS_FATAL_ERROR("--sampleInterval must be positive");
+  }
+  if (harvesterName != "none" && !BatteryHarvester::Create(harvesterName))
+  {
+    NS_FATAL_ERROR("Unknown harvester " << harvesterName << ", use none, constant or solar");
+  }
+
   SeedManager::SetSeed(seed);
 
   if (logging)
   {
     LogComponentEnable("Database", LOG_LEVEL_INFO);
     LogComponentEnable("Controller", LOG_LEVEL_INFO);
+    LogComponentEnable("CustomNode", LOG_LEVEL_INFO);
+    LogComponentEnable("POSITRON", LOG_LEVEL_INFO);
     LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
   }
 
-  cout << "Carregando YAML de entrada..." << endl;
-  YAML::Node input = YAML::LoadFile("./scratch/input.yaml");
+  NS_LOG_INFO("Carregando YAML de entrada...");
+  ScenarioReader reader;
+  if (!reader.Open(inputFile))
+  {
+    NS_FATAL_ERROR("Could not open input file " << inputFile);
+  }
+  YAML::Node input = reader.GetHeader();
   YAML::Node nodes = input["nodes"];
-  YAML::Node apps = input["applications"];
 
   u_int32_t simulationTime = input["configs"][1]["simulationTime"].as<int>();
 
@@ -76,14 +190,14 @@ int main(int argc, char *argv[])
       double transmission = attr["transmission"].as<double>();
       double storage = attr["storage"].as<double>();
 
-      cout << "Configurando " << nodeQtd << " nós do tipo " << nodeName << ":" << endl;
-      cout << "  - Power: " << power << " W" << endl;
-      cout << "  - Initial Consumption: " << initialConsumption << " W" << endl;
-      cout << "  - Current Consumption: " << currentConsumption << " W" << endl;
-      cout << "  - CPU: " << cpu << " GHz" << endl;
-      cout << "  - Memory: " << memory << " GB" << endl;
-      cout << "  - Transmission: " << transmission << " Mbps" << endl;
-      cout << "  - Storage: " << storage << " GB" << endl;
+      NS_LOG_INFO("Configurando " << nodeQtd << " nós do tipo " << nodeName << ":\n"
+                  << "  - Power: " << power << " W\n"
+                  << "  - Initial Consumption: " << initialConsumption << " W\n"
+                  << "  - Current Consumption: " << currentConsumption << " W\n"
+                  << "  - CPU: " << cpu << " GHz\n"
+                  << "  - Memory: " << memory << " GB\n"
+                  << "  - Transmission: " << transmission << " Mbps\n"
+                  << "  - Storage: " << storage << " GB");
 
       int count = 0;
       float factor = (float)loss / 100;
@@ -105,13 +219,17 @@ int main(int argc, char *argv[])
           node->SetAttribute("InitialConsumption", DoubleValue(0.001157407));
           node->SetAttribute("CurrentConsumption", DoubleValue(0.001157407));
         }
+        if (harvesterName != "none")
+        {
+          node->SetHarvester(BatteryHarvester::Create(harvesterName));
+        }
 
         workerNodes.Add(node);
 
         string auxWorkerID = attr["name"].as<string>() + to_string(i);
         Names::Add(auxWorkerID, workerNodes.Get(i+contador));
 
-        cout << "  - Nó " << auxWorkerID << " criado no id " << i+contador << endl;
+        NS_LOG_INFO("  - Nó " << auxWorkerID << " criado no id " << i+contador);
       }
       contador += nodeQtd;
     }
@@ -119,81 +237,212 @@ int main(int argc, char *argv[])
 
   controlNodes.Add(workerNodes);
 
-  MobilityHelper mobility;
-  mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-
-  Ptr<ListPositionAllocator> nodesPositionAlloc = CreateObject<ListPositionAllocator>();
-  nodesPositionAlloc->Add(Vector(0.0, 0.0, 0.0));
-  nodesPositionAlloc->Add(Vector(50.0, 0.0, 0.0));
-  mobility.SetPositionAllocator(nodesPositionAlloc);
-  mobility.Install(controlNodes);
-
-  LrWpanHelper ethernet;
-  NetDeviceContainer controlDevices = ethernet.Install(controlNodes);
-  ethernet.CreateAssociatedPan(controlDevices, 10);
-
-  InternetStackHelper stack;
-  stack.SetIpv4StackInstall(false);
-  stack.Install(controlNodes);
-
-  SixLowPanHelper sixlowpan;
-  NetDeviceContainer sixlpDevices = sixlowpan.Install(controlDevices);
-
-  Ipv6AddressHelper address;
-  address.SetBase(Ipv6Address("2001:1::"), Ipv6Prefix(64));
-  Ipv6InterfaceContainer controlInterfaces = address.Assign(sixlpDevices);
-  
-  Ptr<Controller> controller = CreateObject<Controller>();
-  controlNodes.Get(0)->AddApplication(controller);
-  controller->SetStartTime(Seconds(1.0));
-  controller->SetStopTime(Seconds(2*simulationTime));
-
-  UdpEchoServerHelper workerServer(7);
-  ApplicationContainer workerApps = workerServer.Install(workerNodes);
-  workerApps.Start(Seconds(1.0));
-  workerApps.Stop(Seconds(2*simulationTime));
-
-  // Mandando controlNodes para que seja tratado sincronizado com os ids do banco que começam do 1 ao invés do 0
-
-  controller->ResetDatabase();
-  controller->SetOptions(balanced);
-  controller->AddWorkers(controlNodes);
-
-  for (std::size_t i = 0; i < apps.size(); i++)
-  {
-
-    std::string policy = apps[i]["policy"].as<std::string>();
-    float cpu = apps[i]["cpu"].as<float>();
-    float memory = apps[i]["memory"].as<float>();
-    float storage = apps[i]["storage"].as<float>();
-    float start = 0.0;
-    float startAux = apps[i]["start"].as<float>();
-    float startMin = startAux + 10;
-    float startMax = startAux + 3600;
-    Ptr<UniformRandomVariable> rndStart = CreateObject<UniformRandomVariable> ();
-    rndStart->SetAttribute ("Min", DoubleValue (startMin));
-    rndStart->SetAttribute ("Max", DoubleValue (startMax));
-    start = rndStart->GetValue ();
-    float duration = 0.0;
-    float durationMean = apps[i]["duration"].as<float>();
-    float durationVar = pow((durationMean * 0.20), 2);
-    while(duration <= 0.0) {
-      Ptr<NormalRandomVariable> rndDuration = CreateObject<NormalRandomVariable> ();
-      rndDuration->SetAttribute ("Mean", DoubleValue (durationMean));
-      rndDuration->SetAttribute ("Variance", DoubleValue (durationVar));
-      duration = rndDuration->GetValue ();
+  Ipv6InterfaceContainer controlInterfaces;
+  if (network == NETWORK_LRWPAN)
+  {
+    controlInterfaces = InstallLrWpanNetwork(controlNodes, Seconds(2*simulationTime));
+  }
+
+  // Node 0 of every region is its controller, followed by its share of the workers
+  vector<Ptr<Controller>> controllers;
+  for (uint32_t r = 0; r < regions; ++r)
+  {
+    NodeContainer regionNodes;
+    if (r == 0)
+    {
+      regionNodes.Add(controlNodes.Get(0));
+    }
+    else
+    {
+      Ptr<Node> regionNode = CreateObject<Node>();
+      Names::Add("Controller" + to_string(r), regionNode);
+      regionNodes.Add(regionNode);
     }
+    uint32_t first = uint64_t(r) * workerNodes.GetN() / regions;
+    uint32_t last = uint64_t(r + 1) * workerNodes.GetN() / regions;
+    for (uint32_t i = first; i < last; ++i)
+    {
+      regionNodes.Add(workerNodes.Get(i));
+    }
+
+    Ptr<Controller> controller = CreateObject<Controller>();
+    regionNodes.Get(0)->AddApplication(controller);
+    controller->SetStartTime(Seconds(1.0));
+    controller->SetStopTime(Seconds(2*simulationTime));
 
-    int app_id = i + 1;
+    // Mandando regionNodes para que seja tratado sincronizado com os ids do banco que começam do 1 ao invés do 0
 
-    controller->AddApp(policy, start, duration, cpu, memory, storage);
-    
-    // Mandando controlNodes para que seja tratado sincronizado com os ids do banco que começam do 1 ao invés do 0
-    Simulator::Schedule(Seconds(start), &Controller::AllocateApp, controller, app_id, controlNodes);
+    DatabaseOptions regionDbOptions = dbOptions;
+    if (regions > 1)
+    {
+      size_t dot = dbOptions.path.rfind('.');
+      size_t slash = dbOptions.path.rfind('/');
+      if (dot == string::npos || (slash != string::npos && dot < slash))
+      {
+        dot = dbOptions.path.size();
+      }
+      regionDbOptions.path.insert(dot, "-region" + to_string(r));
+    }
+    controller->SetAudit(audit);
+    controller->SetDatabaseOptions(regionDbOptions);
+    controller->ResetDatabase();
+    controller->SetOptions(balanced);
+    controller->SetReallocationCap(reallocationCap);
+    controller->SetLookahead(lookahead);
+    controller->SetAttribute("RechargeThreshold", DoubleValue(rechargeThreshold));
+    controller->SetMigration(migrate, checkpointInterval);
+    controller->AddWorkers(regionNodes);
+    controllers.push_back(controller);
+  }
+
+  Ptr<Controller> controller = controllers[0];
+  if (controlPlane)
+  {
+    controller->SetAttribute("BatchSize", UintegerValue(batchSize));
+    controller->SetAttribute("BatchDelay", TimeValue(Seconds(batchDelay)));
+    controller->SetAttribute("ControlEnergyPerByte", DoubleValue(controlEnergy));
+    controller->SetControlPlane(controlInterfaces);
+    for (uint32_t i = 0; i < workerNodes.GetN(); ++i)
+    {
+      Ptr<WorkerAgent> agent = CreateObject<WorkerAgent>();
+      agent->SetAttribute("HeartbeatInterval", TimeValue(Seconds(heartbeat)));
+      agent->AssignStreams(4 + i);
+      workerNodes.Get(i)->AddApplication(agent);
+      agent->SetStartTime(Seconds(1.0));
+      agent->SetStopTime(Seconds(2*simulationTime));
+      controller->AddWorkerAgent(i + 1, agent);
+    }
+  }
+
+  TraceRecorder recorder;
+  if (!traceFile.empty())
+  {
+    if (!recorder.Open(traceFile, TraceRecorder::ParseFormat(traceFormat)))
+    {
+      NS_FATAL_ERROR("Could not open trace file " << traceFile);
+    }
+    recorder.Connect(controller);
+  }
+
+  DecisionLog decisions;
+  if (!decisionFile.empty())
+  {
+    if (!decisions.Open(decisionFile))
+    {
+      NS_FATAL_ERROR("Could not open decision file " << decisionFile);
+    }
+    decisions.Connect(controller);
+  }
+  DecisionReplay replay;
+  if (!replayFile.empty() && !replay.Open(replayFile, controller))
+  {
+    NS_FATAL_ERROR("Could not read decision file " << replayFile);
+  }
+
+  UtilizationSampler sampler;
+  if (!samplesFile.empty())
+  {
+    if (!sampler.Open(samplesFile, Seconds(sampleInterval)))
+    {
+      NS_FATAL_ERROR("Could not open samples file " << samplesFile);
+    }
+    for (Ptr<Controller> region : controllers)
+    {
+      sampler.Attach(region);
+    }
+    sampler.Start(Seconds(2*simulationTime));
+  }
+
+  Ptr<Broker> broker;
+  if (regions > 1)
+  {
+    broker = CreateObject<Broker>();
+    broker->SetAttribute("ForwardDelay", TimeValue(Seconds(forwardDelay)));
+    for (Ptr<Controller> region : controllers)
+    {
+      broker->AddRegion(region);
+    }
+  }
+
+  ArrivalGenerator arrivals = broker ? ArrivalGenerator(broker) : ArrivalGenerator(controller);
+  arrivals.SetWindow(Seconds(window));
+  if (arrivalRate > 0.0)
+  {
+    arrivals.SetSynthetic(arrivalRate, arrivalCount);
+  }
+  arrivals.AssignStreams(0);
+  if (replayFile.empty())
+  {
+    arrivals.Start(&reader);
+  }
+  else
+  {
+    replay.Start();
   }
 
   Simulator::Run();
   Simulator::Destroy();
+  recorder.Close();
+  sampler.Close();
+  decisions.Close();
+  if (replay.GetMisses() > 0)
+  {
+    cerr << replay.GetMisses() << " placement attempts had no recorded decision; the replay diverged" << endl;
+  }
+
+  STATS stats{};
+  vector<double> latencies;
+  for (Ptr<Controller> region : controllers)
+  {
+    const STATS &regionStats = region->GetStats();
+    stats.ALLOCATIONS += regionStats.ALLOCATIONS;
+    stats.FAILURES += regionStats.FAILURES;
+    stats.REALLOCATIONS += regionStats.REALLOCATIONS;
+    stats.COMPLETED += regionStats.COMPLETED;
+    stats.PREEMPTED += regionStats.PREEMPTED;
+    stats.BATTERY_DEATHS += regionStats.BATTERY_DEATHS;
+    stats.FORWARDED += regionStats.FORWARDED;
+    stats.MIGRATIONS += regionStats.MIGRATIONS;
+    stats.DOOMED += regionStats.DOOMED;
+    stats.CONTROL_BYTES += regionStats.CONTROL_BYTES;
+    stats.HEARTBEATS += regionStats.HEARTBEATS;
+    stats.RETRANSMISSIONS += regionStats.RETRANSMISSIONS;
+    stats.RECHARGES += regionStats.RECHARGES;
+    stats.WASTED_SECONDS += regionStats.WASTED_SECONDS;
+    latencies.insert(latencies.end(), region->GetPlacementLatencies().begin(), region->GetPlacementLatencies().end());
+  }
+  if (!latencyFile.empty())
+  {
+    ofstream samples(latencyFile);
+    for (double latency : latencies)
+    {
+      samples << latency << "\n";
+    }
+  }
+  sort(latencies.begin(), latencies.end());
+  double latencyMean = 0.0;
+  for (double latency : latencies)
+  {
+    latencyMean += latency / latencies.size();
+  }
+  if (!summaryFile.empty())
+  {
+    ofstream summary(summaryFile);
+    summary << "seed,loss,balanced,powerless,apps,workers,allocations,failures,reallocations,completed,preempted,battery_deaths,migrations,doomed,wasted_app_seconds,"
+            << "control_bytes,control_bytes_per_allocation,heartbeats,retransmissions,latency_mean,latency_p50,latency_p95,latency_p99,"
+            << "regions,forwarded,placed_remotely,returned,recharges" << endl;
+    summary << seed << "," << loss << "," << balanced << "," << powerless << ","
+            << (replayFile.empty() ? arrivals.GetGenerated() : replay.GetGenerated()) << "," << workerNodes.GetN() << ","
+            << stats.ALLOCATIONS << "," << stats.FAILURES << "," << stats.REALLOCATIONS << ","
+            << stats.COMPLETED << "," << stats.PREEMPTED << "," << stats.BATTERY_DEATHS << ","
+            << stats.MIGRATIONS << "," << stats.DOOMED << "," << stats.WASTED_SECONDS << ","
+            << stats.CONTROL_BYTES << "," << (stats.ALLOCATIONS ? double(stats.CONTROL_BYTES) / stats.ALLOCATIONS : 0.0) << ","
+            << stats.HEARTBEATS << "," << stats.RETRANSMISSIONS << "," << latencyMean << ","
+            << Percentile(latencies, 50) << "," << Percentile(latencies, 95) << "," << Percentile(latencies, 99) << ","
+            << regions << "," << stats.FORWARDED << ","
+            << (broker ? broker->GetPlacedRemotely() : 0) << "," << (broker ? broker->GetReturned() : 0) << ","
+            << stats.RECHARGES << endl;
+  }
 
   return 0;
 }
\ No newline at end of file
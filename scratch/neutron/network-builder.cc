@@ -0,0 +1,72 @@
+#include "network-builder.h"
+
+#include "ns3/abort.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/lr-wpan-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/sixlowpan-helper.h"
+#include "ns3/udp-echo-helper.h"
+
+namespace ns3 {
+
+static const uint32_t MAX_PAN_DEVICES = 65533;
+
+bool ParseNetworkMode(const std::string &name, NetworkMode &mode)
+{
+    if (name == "none")
+    {
+        mode = NETWORK_NONE;
+        return true;
+    }
+    if (name == "lrwpan")
+    {
+        mode = NETWORK_LRWPAN;
+        return true;
+    }
+    return false;
+}
+
+Ipv6InterfaceContainer InstallLrWpanNetwork(NodeContainer controlNodes, Time stop)
+{
+    NS_ABORT_MSG_IF(controlNodes.GetN() > MAX_PAN_DEVICES,
+                    "The LrWpan network holds at most " << MAX_PAN_DEVICES - 1 << " workers, use --network=none");
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    Ptr<ListPositionAllocator> nodesPositionAlloc = CreateObject<ListPositionAllocator>();
+    nodesPositionAlloc->Add(Vector(0.0, 0.0, 0.0));
+    nodesPositionAlloc->Add(Vector(50.0, 0.0, 0.0));
+    mobility.SetPositionAllocator(nodesPositionAlloc);
+    mobility.Install(controlNodes);
+
+    LrWpanHelper ethernet;
+    NetDeviceContainer controlDevices = ethernet.Install(controlNodes);
+    ethernet.CreateAssociatedPan(controlDevices, 10);
+
+    InternetStackHelper stack;
+    stack.SetIpv4StackInstall(false);
+    stack.Install(controlNodes);
+
+    SixLowPanHelper sixlowpan;
+    NetDeviceContainer sixlpDevices = sixlowpan.Install(controlDevices);
+
+    Ipv6AddressHelper address;
+    address.SetBase(Ipv6Address("2001:1::"), Ipv6Prefix(64));
+    Ipv6InterfaceContainer controlInterfaces = address.Assign(sixlpDevices);
+
+    NodeContainer workerNodes;
+    for (uint32_t i = 1; i < controlNodes.GetN(); ++i)
+    {
+        workerNodes.Add(controlNodes.Get(i));
+    }
+    UdpEchoServerHelper workerServer(7);
+    ApplicationContainer workerApps = workerServer.Install(workerNodes);
+    workerApps.Start(Seconds(1.0));
+    workerApps.Stop(stop);
+
+    return controlInterfaces;
+}
+
+} // namespace ns3
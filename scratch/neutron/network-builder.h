@@ -0,0 +1,37 @@
+#ifndef NETWORK_BUILDER_H
+#define NETWORK_BUILDER_H
+
+#include "ns3/ipv6-interface-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * How much of the packet-level network a neutron run builds.
+ *
+ * NETWORK_NONE builds nothing: the controller works only on its worker
+ * registry, which is all a placement or energy study needs.
+ * NETWORK_LRWPAN gives every node an 802.15.4 device in one PAN, a
+ * 6LoWPAN/IPv6 stack and a UDP echo server on the workers.
+ */
+enum NetworkMode
+{
+  NETWORK_NONE = 0,
+  NETWORK_LRWPAN
+};
+
+bool ParseNetworkMode (const std::string &name, NetworkMode &mode);
+
+/**
+ * Installs the LrWpan network on controlNodes, whose node 0 is the
+ * controller and node i is worker i.  Returns the IPv6 interfaces in the
+ * same order.  A single PAN holds at most 65533 devices.
+ */
+Ipv6InterfaceContainer InstallLrWpanNetwork (NodeContainer controlNodes, Time stop);
+
+} // namespace ns3
+
+#endif // NETWORK_BUILDER_H
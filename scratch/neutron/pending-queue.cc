@@ -0,0 +1,115 @@
+#include "pending-queue.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace ns3 {
+
+// Quarter-octave classes: members of a class never differ by more than ~19%
+static const double CLASSES_PER_OCTAVE = 4.0;
+
+PendingQueue::PendingQueue()
+{
+}
+
+int PendingQueue::Classify(double value)
+{
+    if (value <= 0.0)
+    {
+        return INT_MIN;
+    }
+    return static_cast<int>(std::floor(std::log2(value) * CLASSES_PER_OCTAVE));
+}
+
+double PendingQueue::LowerBound(int demandClass)
+{
+    if (demandClass == INT_MIN)
+    {
+        return 0.0;
+    }
+    // Slightly below the exact boundary so rounding never hides a member that fits
+    return std::exp2(demandClass / CLASSES_PER_OCTAVE) * (1.0 - 1e-9);
+}
+
+void PendingQueue::Add(const APP &app)
+{
+    if (Contains(app.ID))
+    {
+        return;
+    }
+    Key key(app.POLICY, Classify(app.CPU), Classify(app.MEMORY), Classify(app.STORAGE));
+    auto it = m_buckets.find(key);
+    if (it == m_buckets.end())
+    {
+        Bucket bucket;
+        bucket.cpu = LowerBound(std::get<1>(key));
+        bucket.memory = LowerBound(std::get<2>(key));
+        bucket.storage = LowerBound(std::get<3>(key));
+        it = m_buckets.emplace(key, bucket).first;
+    }
+    it->second.apps[app.ID] = Demand{app.CPU, app.MEMORY, app.STORAGE};
+    m_keys.emplace(app.ID, key);
+}
+
+void PendingQueue::Remove(int appId)
+{
+    auto where = m_keys.find(appId);
+    if (where == m_keys.end())
+    {
+        return;
+    }
+    auto it = m_buckets.find(where->second);
+    it->second.apps.erase(appId);
+    if (it->second.apps.empty())
+    {
+        m_buckets.erase(it);
+    }
+    m_keys.erase(where);
+}
+
+bool PendingQueue::Contains(int appId) const
+{
+    return m_keys.count(appId) > 0;
+}
+
+std::size_t PendingQueue::GetSize() const
+{
+    return m_keys.size();
+}
+
+// Oldest applications first, as the FINISH = 3 query used to return them
+std::vector<int> PendingQueue::GetCandidates(double cpu, double memory, double storage, uint32_t limit) const
+{
+    std::vector<int> candidates;
+    for (const auto &entry : m_buckets)
+    {
+        const Bucket &bucket = entry.second;
+        if (bucket.cpu > cpu || bucket.memory > memory || bucket.storage > storage)
+        {
+            continue;
+        }
+        uint32_t taken = 0;
+        for (const auto &app : bucket.apps)
+        {
+            if (limit > 0 && taken >= limit)
+            {
+                break;
+            }
+            const Demand &demand = app.second;
+            if (demand.cpu <= cpu && demand.memory <= memory && demand.storage <= storage)
+            {
+                candidates.push_back(app.first);
+                taken++;
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    if (limit > 0 && candidates.size() > limit)
+    {
+        candidates.resize(limit);
+    }
+    return candidates;
+}
+
+} // namespace ns3
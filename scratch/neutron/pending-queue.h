@@ -0,0 +1,64 @@
+#ifndef PENDING_QUEUE_H
+#define PENDING_QUEUE_H
+
+#include "structs.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Applications waiting for a worker (FINISH = 3), bucketed by policy and by
+ * a logarithmic class of their CPU, memory and storage demand.
+ *
+ * When a worker releases capacity the controller asks for the applications
+ * that fit what that worker now has free.  Buckets whose lower bound does
+ * not fit are skipped without looking at their members, so the cost of a
+ * release depends on what could actually be placed rather than on the
+ * length of the queue.
+ */
+class PendingQueue
+{
+public:
+  PendingQueue ();
+
+  void Add (const APP &app);
+  void Remove (int appId);
+  bool Contains (int appId) const;
+  std::size_t GetSize () const;
+
+  std::vector<int> GetCandidates (double cpu, double memory, double storage, uint32_t limit) const;
+
+private:
+  typedef std::tuple<std::string, int, int, int> Key;
+
+  struct Demand
+  {
+    double cpu;
+    double memory;
+    double storage;
+  };
+
+  struct Bucket
+  {
+    double cpu;
+    double memory;
+    double storage;
+    std::map<int, Demand> apps;
+  };
+
+  static int Classify (double value);
+  static double LowerBound (int demandClass);
+
+  std::map<Key, Bucket> m_buckets;
+  std::unordered_map<int, Key> m_keys;
+};
+
+} // namespace ns3
+
+#endif // PENDING_QUEUE_H
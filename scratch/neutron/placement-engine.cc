@@ -0,0 +1,338 @@
+#include "placement-engine.h"
+
+#include "ns3/simulator.h"
+
+#include <cstring>
+#include <limits>
+
+namespace ns3 {
+
+PlacementEngine::Policy
+PlacementEngine::ParsePolicy(const char *name)
+{
+    if (strcmp(name, "performance") == 0)
+    {
+        return PERFORMANCE;
+    }
+    if (strcmp(name, "storage") == 0)
+    {
+        return STORAGE;
+    }
+    if (strcmp(name, "transmission") == 0)
+    {
+        return TRANSMISSION;
+    }
+    return FIRST_FIT;
+}
+
+PlacementEngine::PlacementEngine()
+    : m_minPower(50.0),
+      m_lookahead(false),
+      m_powerBase(0.0),
+      m_consumptionSum(0.0)
+{
+}
+
+void PlacementEngine::SetMinPower(double minPower) { m_minPower = minPower; }
+double PlacementEngine::GetMinPower() const { return m_minPower; }
+void PlacementEngine::SetLookahead(bool lookahead) { m_lookahead = lookahead; }
+bool PlacementEngine::GetLookahead() const { return m_lookahead; }
+uint32_t PlacementEngine::GetN() const { return m_cpu.size(); }
+
+double PlacementEngine::GetCpuRemaining(int workerId) const { return m_cpu[workerId - 1]; }
+double PlacementEngine::GetMemoryRemaining(int workerId) const { return m_memory[workerId - 1]; }
+double PlacementEngine::GetStorageRemaining(int workerId) const { return m_storage[workerId - 1]; }
+double PlacementEngine::GetPower(int workerId) const
+{
+    return PowerAt(workerId - 1, Simulator::Now().GetSeconds());
+}
+
+uint32_t PlacementEngine::GetApplicationCount(int workerId) const { return m_apps[workerId - 1]; }
+
+int PlacementEngine::AddWorker(double cpu, double memory, double storage, double transmission, double power,
+                               double consumption, double appConsumption)
+{
+    m_cpuCapacity.push_back(cpu);
+    m_memoryCapacity.push_back(memory);
+    m_storageCapacity.push_back(storage);
+    m_cpu.push_back(cpu);
+    m_memory.push_back(memory);
+    m_storage.push_back(storage);
+    m_transmission.push_back(transmission);
+    m_power.push_back(0.0);
+    m_since.push_back(0.0);
+    m_consumption.push_back(0.0);
+    m_appConsumption.push_back(appConsumption);
+    m_apps.push_back(0);
+    m_indexed.push_back(false);
+
+    int workerId = m_cpu.size();
+    UpdateBattery(workerId, power, consumption);
+    return workerId;
+}
+
+void PlacementEngine::Allocate(int workerId, double cpu, double memory, double storage)
+{
+    uint32_t i = workerId - 1;
+    bool indexed = m_indexed[i];
+    if (indexed)
+    {
+        Unindex(i);
+    }
+    m_cpu[i] -= cpu;
+    m_memory[i] -= memory;
+    m_storage[i] -= storage;
+    m_apps[i] += 1;
+    if (indexed)
+    {
+        Index(i);
+    }
+}
+
+void PlacementEngine::Deallocate(int workerId, double cpu, double memory, double storage)
+{
+    uint32_t i = workerId - 1;
+    bool indexed = m_indexed[i];
+    if (indexed)
+    {
+        Unindex(i);
+    }
+    m_apps[i] -= 1;
+    if (m_apps[i] == 0)
+    {
+        // Snap back to capacity so rounding does not accumulate over long runs
+        m_cpu[i] = m_cpuCapacity[i];
+        m_memory[i] = m_memoryCapacity[i];
+        m_storage[i] = m_storageCapacity[i];
+    }
+    else
+    {
+        m_cpu[i] += cpu;
+        m_memory[i] += memory;
+        m_storage[i] += storage;
+    }
+    if (indexed)
+    {
+        Index(i);
+    }
+}
+
+void PlacementEngine::UpdateBattery(int workerId, double power, double consumption)
+{
+    uint32_t i = workerId - 1;
+    double now = Simulator::Now().GetSeconds();
+    m_powerBase -= m_power[i] + m_since[i] * m_consumption[i];
+    m_consumptionSum -= m_consumption[i];
+
+    // An empty battery does not drain any further, keep it out of the running sums
+    if (power <= 0.0)
+    {
+        power = 0.0;
+        consumption = 0.0;
+    }
+    m_power[i] = power;
+    m_since[i] = now;
+    m_consumption[i] = consumption;
+    m_powerBase += power + now * consumption;
+    m_consumptionSum += consumption;
+
+    if (power > m_minPower && !m_indexed[i])
+    {
+        Index(i);
+    }
+    else if (power <= m_minPower && m_indexed[i])
+    {
+        Unindex(i);
+    }
+}
+
+double PlacementEngine::GetAveragePower() const
+{
+    if (m_power.empty())
+    {
+        return 0.0;
+    }
+    double now = Simulator::Now().GetSeconds();
+    return (m_powerBase - now * m_consumptionSum) / m_power.size();
+}
+
+int PlacementEngine::SelectWorker(double cpu, double memory, double storage, double duration, Policy policy,
+                                  bool balanced)
+{
+    const std::set<Key> &index = m_index[policy][balanced ? 1 : 0];
+    double now = Simulator::Now().GetSeconds();
+    std::vector<uint32_t> drained;
+    int selected = 0;
+    int doomed = 0; // first fitting worker projected to die before the application ends
+    for (auto it = index.begin(); it != index.end();)
+    {
+        const Key &key = *it;
+        uint32_t i = std::get<2>(key) - 1;
+        double power = PowerAt(i, now);
+        if (power <= m_minPower)
+        {
+            drained.push_back(i);
+            ++it;
+            continue;
+        }
+        if (Fits(i, cpu, memory, storage))
+        {
+            if (!m_lookahead || OutlivesAt(i, power, duration))
+            {
+                selected = i + 1;
+                break;
+            }
+            if (doomed == 0)
+            {
+                doomed = i + 1;
+            }
+            ++it;
+            continue;
+        }
+        // The index is sorted by the constrained resource itself, nothing further down can
+        // fit: stop, or in balanced mode skip to the workers running one more application
+        if ((policy == PERFORMANCE && m_cpu[i] < cpu) || (policy == STORAGE && m_storage[i] < storage))
+        {
+            if (!balanced)
+            {
+                break;
+            }
+            it = index.lower_bound(Key(std::get<0>(key) + 1, -std::numeric_limits<double>::infinity(), 0));
+            continue;
+        }
+        ++it;
+    }
+    for (uint32_t i : drained)
+    {
+        Unindex(i);
+    }
+    return selected > 0 ? selected : doomed;
+}
+
+int PlacementEngine::SelectWorker(double cpu, double memory, double storage, double duration,
+                                  const PlacementPolicy &policy)
+{
+    uint32_t n = m_cpu.size();
+    double now = Simulator::Now().GetSeconds();
+    m_powerNow.resize(n);
+    m_scores.resize(n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        double power = m_power[i] - (now - m_since[i]) * m_consumption[i];
+        m_powerNow[i] = power < 0.0 ? 0.0 : power;
+    }
+
+    PlacementColumns columns;
+    columns.n = n;
+    columns.cpu = m_cpu.data();
+    columns.memory = m_memory.data();
+    columns.storage = m_storage.data();
+    columns.cpuCapacity = m_cpuCapacity.data();
+    columns.memoryCapacity = m_memoryCapacity.data();
+    columns.storageCapacity = m_storageCapacity.data();
+    columns.transmission = m_transmission.data();
+    columns.power = m_powerNow.data();
+    columns.consumption = m_consumption.data();
+    columns.apps = m_apps.data();
+    policy.Score(columns, cpu, memory, storage, m_scores.data());
+
+    const double excluded = -std::numeric_limits<double>::infinity();
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        bool eligible = m_powerNow[i] > m_minPower && m_cpu[i] >= cpu && m_memory[i] >= memory &&
+                        m_storage[i] >= storage;
+        m_scores[i] = eligible ? m_scores[i] : excluded;
+    }
+    int selected = 0;
+    double best = excluded;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (m_scores[i] > best)
+        {
+            best = m_scores[i];
+            selected = i + 1;
+        }
+    }
+    if (!m_lookahead || selected == 0 || OutlivesAt(selected - 1, m_powerNow[selected - 1], duration))
+    {
+        return selected;
+    }
+
+    // The best worker would die first; take the best one that survives, if any
+    int survivor = 0;
+    best = excluded;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (m_scores[i] > best && OutlivesAt(i, m_powerNow[i], duration))
+        {
+            best = m_scores[i];
+            survivor = i + 1;
+        }
+    }
+    return survivor > 0 ? survivor : selected;
+}
+
+bool PlacementEngine::Outlives(int workerId, double duration) const
+{
+    uint32_t i = workerId - 1;
+    return OutlivesAt(i, PowerAt(i, Simulator::Now().GetSeconds()), duration);
+}
+
+PlacementEngine::Key PlacementEngine::MakeKey(uint32_t i, Policy policy, bool balanced) const
+{
+    double metric = 0.0;
+    switch (policy)
+    {
+    case PERFORMANCE:
+        metric = -m_cpu[i];
+        break;
+    case STORAGE:
+        metric = -m_storage[i];
+        break;
+    case TRANSMISSION:
+        metric = -m_transmission[i];
+        break;
+    default:
+        break;
+    }
+    return Key(balanced ? m_apps[i] : 0, metric, i + 1);
+}
+
+void PlacementEngine::Index(uint32_t i)
+{
+    for (int p = 0; p < POLICY_COUNT; ++p)
+    {
+        m_index[p][0].insert(MakeKey(i, static_cast<Policy>(p), false));
+        m_index[p][1].insert(MakeKey(i, static_cast<Policy>(p), true));
+    }
+    m_indexed[i] = true;
+}
+
+void PlacementEngine::Unindex(uint32_t i)
+{
+    for (int p = 0; p < POLICY_COUNT; ++p)
+    {
+        m_index[p][0].erase(MakeKey(i, static_cast<Policy>(p), false));
+        m_index[p][1].erase(MakeKey(i, static_cast<Policy>(p), true));
+    }
+    m_indexed[i] = false;
+}
+
+double PlacementEngine::PowerAt(uint32_t i, double now) const
+{
+    double power = m_power[i] - (now - m_since[i]) * m_consumption[i];
+    return power < 0.0 ? 0.0 : power;
+}
+
+bool PlacementEngine::OutlivesAt(uint32_t i, double power, double duration) const
+{
+    // Other applications leaving early only make the projection pessimistic
+    return power - (m_consumption[i] + m_appConsumption[i]) * duration > 0.0;
+}
+
+bool PlacementEngine::Fits(uint32_t i, double cpu, double memory, double storage) const
+{
+    return m_cpu[i] >= cpu && m_memory[i] >= memory && m_storage[i] >= storage;
+}
+
+} // namespace ns3
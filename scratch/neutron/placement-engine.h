@@ -0,0 +1,131 @@
+#ifndef PLACEMENT_ENGINE_H
+#define PLACEMENT_ENGINE_H
+
+#include "placement-policy.h"
+
+#include <cstdint>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * In-memory view of the worker pool used to place applications.
+ *
+ * Remaining resources, application count and battery of every worker are
+ * kept in contiguous columns and updated incrementally on allocation and
+ * deallocation.  One ordered index per (policy, balanced) pair keeps the
+ * workers sorted the same way the old SQL "ORDER BY" clauses did, and the
+ * best worker is the first one that fits the request walking the index
+ * from its head.
+ *
+ * The walk is only logarithmic when the index is sorted by the resource
+ * that does not fit: PERFORMANCE and STORAGE stop at the first worker
+ * short of CPU or storage, and their balanced variants skip to the next
+ * application count, so they cost O(g log n) for g distinct application
+ * counts.  TRANSMISSION and FIRST_FIT, a worker short of memory, and
+ * workers passed over by lookahead are walked one by one, which is O(n)
+ * on a loaded pool.
+ *
+ * Battery levels are not refreshed on every event.  Each worker stores the
+ * level it had at its last update and the rate it drains at, and the level
+ * at the current simulation time is derived from them when needed.  Workers
+ * found at or below the minimum power during a walk are dropped from the
+ * indexes until UpdateBattery raises them again.
+ *
+ * With lookahead enabled, a request also carries how long the application
+ * will run.  Each candidate's battery is projected over that time with the
+ * application's consumption added, and workers that would run dry before
+ * it finishes are only used when no other worker fits.
+ *
+ * Requests that name a PlacementPolicy skip the indexes: the policy scores
+ * the whole pool from the columns in one pass and the best scoring worker
+ * that fits is chosen.
+ *
+ * Worker ids are 1-based to match the ids used by the database and by the
+ * controller's worker registry.
+ */
+class PlacementEngine
+{
+public:
+  enum Policy
+  {
+    PERFORMANCE = 0,
+    STORAGE,
+    TRANSMISSION,
+    FIRST_FIT,
+    POLICY_COUNT
+  };
+
+  static Policy ParsePolicy (const char *name);
+
+  PlacementEngine ();
+
+  void SetMinPower (double minPower);
+  double GetMinPower () const;
+  void SetLookahead (bool lookahead);
+  bool GetLookahead () const;
+
+  /**
+   * appConsumption is the drain each application adds to the worker, used
+   * to project its battery under one more application.
+   */
+  int AddWorker (double cpu, double memory, double storage, double transmission, double power,
+                 double consumption, double appConsumption);
+  uint32_t GetN () const;
+
+  void Allocate (int workerId, double cpu, double memory, double storage);
+  void Deallocate (int workerId, double cpu, double memory, double storage);
+  void UpdateBattery (int workerId, double power, double consumption);
+
+  int SelectWorker (double cpu, double memory, double storage, double duration, Policy policy,
+                    bool balanced);
+  int SelectWorker (double cpu, double memory, double storage, double duration,
+                    const PlacementPolicy &policy);
+  bool Outlives (int workerId, double duration) const;
+  double GetAveragePower () const;
+
+  double GetCpuRemaining (int workerId) const;
+  double GetMemoryRemaining (int workerId) const;
+  double GetStorageRemaining (int workerId) const;
+  double GetPower (int workerId) const;
+  uint32_t GetApplicationCount (int workerId) const;
+
+private:
+  typedef std::tuple<uint32_t, double, int> Key;
+
+  Key MakeKey (uint32_t i, Policy policy, bool balanced) const;
+  void Index (uint32_t i);
+  void Unindex (uint32_t i);
+  bool Fits (uint32_t i, double cpu, double memory, double storage) const;
+  double PowerAt (uint32_t i, double now) const;
+  bool OutlivesAt (uint32_t i, double power, double duration) const;
+
+  double m_minPower;
+  bool m_lookahead;
+  double m_powerBase; // sum of power + since * consumption over draining workers
+  double m_consumptionSum;
+
+  std::vector<double> m_cpuCapacity;
+  std::vector<double> m_memoryCapacity;
+  std::vector<double> m_storageCapacity;
+  std::vector<double> m_cpu;
+  std::vector<double> m_memory;
+  std::vector<double> m_storage;
+  std::vector<double> m_transmission;
+  std::vector<double> m_power;
+  std::vector<double> m_since;
+  std::vector<double> m_consumption;
+  std::vector<double> m_appConsumption;
+  std::vector<uint32_t> m_apps;
+  std::vector<bool> m_indexed;
+  std::vector<double> m_powerNow; // scratch columns for policy scoring
+  std::vector<double> m_scores;
+
+  std::set<Key> m_index[POLICY_COUNT][2];
+};
+
+} // namespace ns3
+
+#endif // PLACEMENT_ENGINE_H
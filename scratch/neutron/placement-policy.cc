@@ -0,0 +1,228 @@
+#include "placement-policy.h"
+
+#include "ns3/double.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(PlacementPolicy);
+NS_OBJECT_ENSURE_REGISTERED(FirstFitPlacementPolicy);
+NS_OBJECT_ENSURE_REGISTERED(BestFitPlacementPolicy);
+NS_OBJECT_ENSURE_REGISTERED(WorstFitPlacementPolicy);
+NS_OBJECT_ENSURE_REGISTERED(BalancedPlacementPolicy);
+NS_OBJECT_ENSURE_REGISTERED(BatteryAwarePlacementPolicy);
+NS_OBJECT_ENSURE_REGISTERED(WeightedPlacementPolicy);
+
+static inline double Fraction(double value, double capacity)
+{
+    return capacity > 0.0 ? value / capacity : 0.0;
+}
+
+// Free capacity left on worker i after the request, as a fraction of its size
+static inline double Slack(const PlacementColumns &c, uint32_t i, double cpu, double memory, double storage)
+{
+    return Fraction(c.cpu[i] - cpu, c.cpuCapacity[i]) + Fraction(c.memory[i] - memory, c.memoryCapacity[i]) +
+           Fraction(c.storage[i] - storage, c.storageCapacity[i]);
+}
+
+TypeId
+PlacementPolicy::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::PlacementPolicy")
+        .SetParent<Object>()
+        .SetGroupName("Applications");
+    return tid;
+}
+
+Ptr<PlacementPolicy>
+PlacementPolicy::Create(const std::string &name)
+{
+    if (name == "first-fit")
+    {
+        return CreateObject<FirstFitPlacementPolicy>();
+    }
+    if (name == "best-fit")
+    {
+        return CreateObject<BestFitPlacementPolicy>();
+    }
+    if (name == "worst-fit")
+    {
+        return CreateObject<WorstFitPlacementPolicy>();
+    }
+    if (name == "balanced")
+    {
+        return CreateObject<BalancedPlacementPolicy>();
+    }
+    if (name == "battery-aware")
+    {
+        return CreateObject<BatteryAwarePlacementPolicy>();
+    }
+    if (name == "weighted")
+    {
+        return CreateObject<WeightedPlacementPolicy>();
+    }
+    return nullptr;
+}
+
+TypeId
+FirstFitPlacementPolicy::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::FirstFitPlacementPolicy")
+        .SetParent<PlacementPolicy>()
+        .SetGroupName("Applications")
+        .AddConstructor<FirstFitPlacementPolicy>();
+    return tid;
+}
+
+void FirstFitPlacementPolicy::Score(const PlacementColumns &c, double, double, double, double *scores) const
+{
+    for (uint32_t i = 0; i < c.n; ++i)
+    {
+        scores[i] = -static_cast<double>(i);
+    }
+}
+
+TypeId
+BestFitPlacementPolicy::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::BestFitPlacementPolicy")
+        .SetParent<PlacementPolicy>()
+        .SetGroupName("Applications")
+        .AddConstructor<BestFitPlacementPolicy>();
+    return tid;
+}
+
+void BestFitPlacementPolicy::Score(const PlacementColumns &c, double cpu, double memory, double storage,
+                                   double *scores) const
+{
+    for (uint32_t i = 0; i < c.n; ++i)
+    {
+        scores[i] = -Slack(c, i, cpu, memory, storage);
+    }
+}
+
+TypeId
+WorstFitPlacementPolicy::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::WorstFitPlacementPolicy")
+        .SetParent<PlacementPolicy>()
+        .SetGroupName("Applications")
+        .AddConstructor<WorstFitPlacementPolicy>();
+    return tid;
+}
+
+void WorstFitPlacementPolicy::Score(const PlacementColumns &c, double cpu, double memory, double storage,
+                                    double *scores) const
+{
+    for (uint32_t i = 0; i < c.n; ++i)
+    {
+        scores[i] = Slack(c, i, cpu, memory, storage);
+    }
+}
+
+TypeId
+BalancedPlacementPolicy::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::BalancedPlacementPolicy")
+        .SetParent<PlacementPolicy>()
+        .SetGroupName("Applications")
+        .AddConstructor<BalancedPlacementPolicy>();
+    return tid;
+}
+
+void BalancedPlacementPolicy::Score(const PlacementColumns &c, double, double, double, double *scores) const
+{
+    for (uint32_t i = 0; i < c.n; ++i)
+    {
+        scores[i] = -static_cast<double>(c.apps[i]);
+    }
+}
+
+TypeId
+BatteryAwarePlacementPolicy::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::BatteryAwarePlacementPolicy")
+        .SetParent<PlacementPolicy>()
+        .SetGroupName("Applications")
+        .AddConstructor<BatteryAwarePlacementPolicy>();
+    return tid;
+}
+
+void BatteryAwarePlacementPolicy::Score(const PlacementColumns &c, double, double, double, double *scores) const
+{
+    // Workers that do not drain rank above any draining one, by battery level
+    for (uint32_t i = 0; i < c.n; ++i)
+    {
+        scores[i] = c.consumption[i] > 0.0 ? c.power[i] / c.consumption[i] : 1e300 * (1.0 + c.power[i]);
+    }
+}
+
+TypeId
+WeightedPlacementPolicy::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::WeightedPlacementPolicy")
+        .SetParent<PlacementPolicy>()
+        .SetGroupName("Applications")
+        .AddConstructor<WeightedPlacementPolicy>()
+        .AddAttribute("CpuWeight",
+                      "Weight of the free CPU fraction.",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&WeightedPlacementPolicy::m_cpuWeight),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("MemoryWeight",
+                      "Weight of the free memory fraction.",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&WeightedPlacementPolicy::m_memoryWeight),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("StorageWeight",
+                      "Weight of the free storage fraction.",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&WeightedPlacementPolicy::m_storageWeight),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("PowerWeight",
+                      "Weight of the battery level, as a fraction of 100.",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&WeightedPlacementPolicy::m_powerWeight),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("TransmissionWeight",
+                      "Weight of the transmission capability, relative to the best worker.",
+                      DoubleValue(0.0),
+                      MakeDoubleAccessor(&WeightedPlacementPolicy::m_transmissionWeight),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("LoadWeight",
+                      "Penalty per application already running on the worker.",
+                      DoubleValue(0.0),
+                      MakeDoubleAccessor(&WeightedPlacementPolicy::m_loadWeight),
+                      MakeDoubleChecker<double>());
+    return tid;
+}
+
+WeightedPlacementPolicy::WeightedPlacementPolicy()
+    : m_cpuWeight(1.0),
+      m_memoryWeight(1.0),
+      m_storageWeight(1.0),
+      m_powerWeight(1.0),
+      m_transmissionWeight(0.0),
+      m_loadWeight(0.0)
+{
+}
+
+void WeightedPlacementPolicy::Score(const PlacementColumns &c, double cpu, double memory, double storage,
+                                    double *scores) const
+{
+    double maxTransmission = 0.0;
+    for (uint32_t i = 0; i < c.n; ++i)
+    {
+        maxTransmission = c.transmission[i] > maxTransmission ? c.transmission[i] : maxTransmission;
+    }
+    double transmissionWeight = maxTransmission > 0.0 ? m_transmissionWeight / maxTransmission : 0.0;
+    for (uint32_t i = 0; i < c.n; ++i)
+    {
+        scores[i] = m_cpuWeight * Fraction(c.cpu[i] - cpu, c.cpuCapacity[i]) +
+                    m_memoryWeight * Fraction(c.memory[i] - memory, c.memoryCapacity[i]) +
+                    m_storageWeight * Fraction(c.storage[i] - storage, c.storageCapacity[i]) +
+                    m_powerWeight * c.power[i] / 100.0 + transmissionWeight * c.transmission[i] -
+                    m_loadWeight * c.apps[i];
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,132 @@
+#ifndef PLACEMENT_POLICY_H
+#define PLACEMENT_POLICY_H
+
+#include "ns3/object.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * Read-only view of the worker pool handed to a PlacementPolicy.
+ *
+ * Every pointer addresses a column of n contiguous values, one per worker,
+ * with worker id i + 1 at index i.  The resource columns hold what is still
+ * free; power is the battery level at the current simulation time.
+ */
+struct PlacementColumns
+{
+  uint32_t n;
+  const double *cpu;
+  const double *memory;
+  const double *storage;
+  const double *cpuCapacity;
+  const double *memoryCapacity;
+  const double *storageCapacity;
+  const double *transmission;
+  const double *power;
+  const double *consumption;
+  const uint32_t *apps;
+};
+
+/**
+ * Scores every worker for one placement request.
+ *
+ * Score() is called once per request with the whole pool and writes one
+ * score per worker in a single pass over the columns; the engine then picks
+ * the highest score among the workers that fit the request and have enough
+ * power, the lowest id winning ties.  Policies do not need to check fit
+ * themselves, and should keep Score() a plain loop over the columns so the
+ * compiler can vectorize it.
+ *
+ * Applications select a policy by name in the "policy" field of the
+ * scenario file; see Create().
+ */
+class PlacementPolicy : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * Creates the policy registered under a scenario name ("first-fit",
+   * "best-fit", "worst-fit", "balanced", "battery-aware" or "weighted").
+   * Returns 0 for any other name.
+   */
+  static Ptr<PlacementPolicy> Create (const std::string &name);
+
+  virtual void Score (const PlacementColumns &columns, double cpu, double memory, double storage,
+                      double *scores) const = 0;
+};
+
+/** Lowest worker id first. */
+class FirstFitPlacementPolicy : public PlacementPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+  void Score (const PlacementColumns &columns, double cpu, double memory, double storage,
+              double *scores) const override;
+};
+
+/** Worker left with the least free capacity, relative to its size, after placement. */
+class BestFitPlacementPolicy : public PlacementPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+  void Score (const PlacementColumns &columns, double cpu, double memory, double storage,
+              double *scores) const override;
+};
+
+/** Worker left with the most free capacity, relative to its size, after placement. */
+class WorstFitPlacementPolicy : public PlacementPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+  void Score (const PlacementColumns &columns, double cpu, double memory, double storage,
+              double *scores) const override;
+};
+
+/** Worker running the fewest applications. */
+class BalancedPlacementPolicy : public PlacementPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+  void Score (const PlacementColumns &columns, double cpu, double memory, double storage,
+              double *scores) const override;
+};
+
+/** Worker whose battery lasts longest at its current drain. */
+class BatteryAwarePlacementPolicy : public PlacementPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+  void Score (const PlacementColumns &columns, double cpu, double memory, double storage,
+              double *scores) const override;
+};
+
+/**
+ * Weighted sum of normalized free CPU, memory and storage, battery level
+ * and transmission, minus a penalty per running application.  The weights
+ * are attributes, so they can be set from the command line, e.g.
+ * --ns3::WeightedPlacementPolicy::PowerWeight=2.
+ */
+class WeightedPlacementPolicy : public PlacementPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+  WeightedPlacementPolicy ();
+  void Score (const PlacementColumns &columns, double cpu, double memory, double storage,
+              double *scores) const override;
+
+private:
+  double m_cpuWeight;
+  double m_memoryWeight;
+  double m_storageWeight;
+  double m_powerWeight;
+  double m_transmissionWeight;
+  double m_loadWeight;
+};
+
+} // namespace ns3
+
+#endif // PLACEMENT_POLICY_H
@@ -0,0 +1,73 @@
+#include "ns3/core-module.h"
+#include "utilization-sampler.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace ns3;
+using namespace std;
+
+// Converts a utilization file written by main --samples to CSV, one row per
+// worker and sample:
+//
+//   time,pending,worker,cpu,memory,storage,power
+//
+// --worker keeps the rows of a single worker.
+
+int main(int argc, char *argv[])
+{
+  string input = "";
+  string output = "";
+  uint32_t worker = 0;
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("input", "Utilization file written by --samples", input);
+  cmd.AddValue("output", "CSV file to write (standard output if empty)", output);
+  cmd.AddValue("worker", "Only this worker id (0 = all)", worker);
+  cmd.Parse(argc, argv);
+
+  if (input.empty())
+  {
+    cmd.PrintHelp(cout);
+    return 0;
+  }
+  UtilizationReader reader;
+  if (!reader.Open(input))
+  {
+    cerr << "Could not read utilization file " << input << endl;
+    return 1;
+  }
+  uint32_t workers = reader.GetNWorkers();
+  if (worker > workers)
+  {
+    cerr << "The file has " << workers << " workers" << endl;
+    return 1;
+  }
+  ofstream file;
+  if (!output.empty())
+  {
+    file.open(output);
+  }
+  ostream &out = output.empty() ? cout : file;
+
+  uint32_t first = worker > 0 ? worker - 1 : 0;
+  uint32_t last = worker > 0 ? worker : workers;
+  out << "time,pending,worker,cpu,memory,storage,power\n";
+  out << setprecision(9);
+  UtilizationBlock block;
+  while (reader.ReadBlock(block))
+  {
+    for (uint32_t k = 0; k < block.samples; ++k)
+    {
+      for (uint32_t w = first; w < last; ++w)
+      {
+        size_t i = size_t(w) * block.samples + k;
+        out << block.time[k] << ',' << block.pending[k] << ',' << w + 1 << ','
+            << block.cpu[i] << ',' << block.memory[i] << ',' << block.storage[i] << ','
+            << block.power[i] << '\n';
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,219 @@
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+using namespace std;
+
+// Writes a synthetic scenario in the input.yaml format read by main.
+//
+// Workers come in --classes node classes of growing size, split evenly over
+// --nodes.  --drainFraction of every class is written as a separate group
+// that draws --drain battery per second while idle, the rest as a group
+// that does not.  Applications arrive as a Poisson process of --rate apps/s,
+// optionally modulated by a daily sine (--arrival=diurnal), with Pareto
+// distributed durations and CPU, memory and storage demands capped at the
+// largest class.  They are written one at a time in arrival order, so
+// memory does not grow with --apps and millions of applications are cheap:
+//
+//   scenario-generator --nodes=10000 --apps=1000000 --rate=20 --output=big.yaml
+//   main --input=big.yaml --network=none --audit=false
+//
+// main still jitters each start by 10 s to 1 h and redraws each duration
+// around the written value, as it does for the hand-written scenarios.
+
+struct NodeClass
+{
+  uint32_t count;
+  double cpu;
+  double memory;
+  double storage;
+  double transmission;
+};
+
+static vector<string> SplitList(const string &list)
+{
+  vector<string> items;
+  stringstream stream(list);
+  string item;
+  while (getline(stream, item, ','))
+  {
+    items.push_back(item);
+  }
+  return items;
+}
+
+static void WriteGroup(ostream &out, const string &name, const NodeClass &nodeClass, uint32_t count, double drain)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  out << "  - nNodes: " << count << "\n"
+      << "    name: \"" << name << "\"\n"
+      << "    power: 100.0\n"
+      << "    initialConsumption: " << drain << "\n"
+      << "    currentConsumption: " << drain << "\n"
+      << "    cpu: " << nodeClass.cpu << "\n"
+      << "    memory: " << nodeClass.memory << "\n"
+      << "    transmission: " << nodeClass.transmission << "\n"
+      << "    storage: " << nodeClass.storage << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+  string output = "";
+  string name = "synthetic";
+  uint32_t nodes = 1000;
+  uint32_t classes = 4;
+  double drainFraction = 0.2;
+  double drain = 0.001157407;
+  uint64_t apps = 10000;
+  string arrival = "poisson";
+  double rate = 1.0;
+  double amplitude = 0.8;
+  double durationMin = 600.0;
+  double durationShape = 1.5;
+  double durationMax = 7 * 86400.0;
+  double demandShape = 2.5;
+  string policies = "performance,storage,transmission";
+  uint32_t simulationTime = 0;
+  uint32_t seed = 1;
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("output", "Scenario file to write (standard output if empty)", output);
+  cmd.AddValue("name", "Scenario name", name);
+  cmd.AddValue("nodes", "Number of workers", nodes);
+  cmd.AddValue("classes", "Number of node classes, each twice the size of the previous one in some resource", classes);
+  cmd.AddValue("drainFraction", "Fraction of every class whose battery drains while idle", drainFraction);
+  cmd.AddValue("drain", "Battery percentage per second drained by those workers", drain);
+  cmd.AddValue("apps", "Number of applications", apps);
+  cmd.AddValue("arrival", "Arrival process: poisson or diurnal", arrival);
+  cmd.AddValue("rate", "Mean arrivals per second", rate);
+  cmd.AddValue("amplitude", "Relative swing of the diurnal arrival rate, between 0 and 1", amplitude);
+  cmd.AddValue("durationMin", "Shortest application duration in seconds", durationMin);
+  cmd.AddValue("durationShape", "Pareto shape of the durations (smaller is heavier tailed)", durationShape);
+  cmd.AddValue("durationMax", "Longest application duration in seconds", durationMax);
+  cmd.AddValue("demandShape", "Pareto shape of the CPU, memory and storage demands", demandShape);
+  cmd.AddValue("policies", "Comma-separated policies the applications cycle through", policies);
+  cmd.AddValue("simulationTime", "Simulated seconds (0 = one day past the last arrival)", simulationTime);
+  cmd.AddValue("seed", "Random seed", seed);
+  cmd.Parse(argc, argv);
+
+  if (arrival != "poisson" && arrival != "diurnal")
+  {
+    cerr << "Unknown arrival process " << arrival << ", use poisson or diurnal" << endl;
+    return 1;
+  }
+  if (rate <= 0.0 || classes == 0)
+  {
+    cerr << "--rate and --classes must be positive" << endl;
+    return 1;
+  }
+  vector<string> policyNames = SplitList(policies);
+  if (policyNames.empty())
+  {
+    policyNames.push_back("performance");
+  }
+  amplitude = clamp(amplitude, 0.0, 1.0);
+  drainFraction = clamp(drainFraction, 0.0, 1.0);
+  RngSeedManager::SetSeed(seed);
+
+  ofstream file;
+  if (!output.empty())
+  {
+    file.open(output);
+    if (!file.is_open())
+    {
+      cerr << "Could not open " << output << endl;
+      return 1;
+    }
+  }
+  ostream &out = output.empty() ? cout : file;
+
+  // Sizes cycle through the resources so classes differ in more than one way
+  vector<NodeClass> nodeClasses;
+  NodeClass largest = {0, 0.0, 0.0, 0.0, 0.0};
+  for (uint32_t c = 0; c < classes; ++c)
+  {
+    NodeClass nodeClass;
+    nodeClass.count = nodes / classes + (c < nodes % classes ? 1 : 0);
+    nodeClass.cpu = 1 << (c % 3);
+    nodeClass.memory = 2 << (c % 4);
+    nodeClass.storage = 16 << (c % 3);
+    nodeClass.transmission = 10.0 * (1 + c % 5);
+    nodeClasses.push_back(nodeClass);
+    largest.cpu = max(largest.cpu, nodeClass.cpu);
+    largest.memory = max(largest.memory, nodeClass.memory);
+    largest.storage = max(largest.storage, nodeClass.storage);
+  }
+
+  Ptr<ExponentialRandomVariable> interArrival = CreateObject<ExponentialRandomVariable>();
+  Ptr<UniformRandomVariable> thinning = CreateObject<UniformRandomVariable>();
+  Ptr<ParetoRandomVariable> duration = CreateObject<ParetoRandomVariable>();
+  Ptr<ParetoRandomVariable> demand = CreateObject<ParetoRandomVariable>();
+  interArrival->SetStream(0);
+  thinning->SetStream(1);
+  duration->SetStream(2);
+  demand->SetStream(3);
+
+  // The header needs the simulation time, so the arrival times are drawn twice from the same stream
+  double peak = arrival == "diurnal" ? rate * (1.0 + amplitude) : rate;
+  auto nextArrival = [&](double t) {
+    while (true)
+    {
+      t += interArrival->GetValue(1.0 / peak, 0.0);
+      // Thinning: keep a candidate with probability rate(t) / peak
+      if (arrival == "poisson" ||
+          thinning->GetValue() * peak <= rate * (1.0 + amplitude * sin(2.0 * M_PI * (t / 86400.0 - 0.25))))
+      {
+        return t;
+      }
+    }
+  };
+  if (simulationTime == 0)
+  {
+    double last = 0.0;
+    for (uint64_t i = 0; i < apps; ++i)
+    {
+      last = nextArrival(last);
+    }
+    simulationTime = static_cast<uint32_t>(ceil(last)) + 86400;
+    interArrival->SetStream(0);
+    thinning->SetStream(1);
+  }
+
+  out << "configs:\n"
+      << "  - scenarioName: \"" << name << "\"\n"
+      << "  - simulationTime: " << simulationTime << "\n\n"
+      << "nodes:\n";
+  for (uint32_t c = 0; c < classes; ++c)
+  {
+    const NodeClass &nodeClass = nodeClasses[c];
+    uint32_t draining = static_cast<uint32_t>(round(nodeClass.count * drainFraction));
+    string prefix = "Class" + to_string(c + 1);
+    WriteGroup(out, prefix + "-", nodeClass, nodeClass.count - draining, 0.0);
+    WriteGroup(out, prefix + "-drain-", nodeClass, draining, drain);
+  }
+
+  out << "\napplications:\n";
+  out << fixed;
+  double t = 0.0;
+  for (uint64_t i = 0; i < apps; ++i)
+  {
+    t = nextArrival(t);
+    out << "  - policy: \"" << policyNames[i % policyNames.size()] << "\"\n"
+        << setprecision(3) << "    start: " << t << "\n"
+        << setprecision(0) << "    duration: " << duration->GetValue(durationMin, durationShape, durationMax) << "\n"
+        << setprecision(3) << "    cpu: " << demand->GetValue(0.1, demandShape, largest.cpu) << "\n"
+        << "    memory: " << demand->GetValue(0.1, demandShape, largest.memory) << "\n"
+        << "    storage: " << demand->GetValue(0.5, demandShape, largest.storage) << "\n";
+  }
+  return 0;
+}
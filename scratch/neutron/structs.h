@@ -1,6 +1,7 @@
 #ifndef STRUCTS_H
 #define STRUCTS_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -14,6 +15,7 @@ struct APP
     float MEMORY;
     float STORAGE;
     char POLICY[20];
+    int PLACEMENT; // 1-based index of the controller's PlacementPolicy, 0 for the indexed policies
 }; 
 
 struct WRK
@@ -29,4 +31,22 @@ struct WRK
     std::vector<int> APPS;
 };
 
-#endif
\ No newline at end of file
+struct STATS
+{
+    uint64_t ALLOCATIONS;    // successful placements, including reallocations
+    uint64_t FAILURES;       // placement attempts that found no worker
+    uint64_t REALLOCATIONS;  // successful placements of applications that had been waiting
+    uint64_t COMPLETED;      // applications that ran until their duration elapsed
+    uint64_t PREEMPTED;      // applications removed from a worker that ran out of power
+    uint64_t BATTERY_DEATHS; // workers that ran out of power
+    uint64_t FORWARDED;      // applications handed to the broker because this region had no room
+    uint64_t MIGRATIONS;     // placements that resumed an application from a checkpoint
+    uint64_t DOOMED;         // placements on a worker projected to run out of power before the application ends
+    uint64_t CONTROL_BYTES;  // control-plane UDP payload bytes sent and received by the controller
+    uint64_t HEARTBEATS;     // worker heartbeats received
+    uint64_t RETRANSMISSIONS; // command batches sent again after a missing acknowledgement
+    uint64_t RECHARGES;      // workers a harvester brought back above the recharge threshold
+    double WASTED_SECONDS;   // application run time lost to preemption
+};
+
+#endif
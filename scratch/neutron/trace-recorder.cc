@@ -0,0 +1,122 @@
+#include "trace-recorder.h"
+
+#include "ns3/simulator.h"
+
+#include <iomanip>
+
+namespace ns3 {
+
+static const std::size_t BUFFERED_RECORDS = 65536;
+static const char BINARY_MAGIC[4] = {'N', 'T', 'R', 'C'};
+static const uint32_t BINARY_VERSION = 1;
+
+TraceRecorder::Format
+TraceRecorder::ParseFormat(const std::string &name)
+{
+    return name == "binary" ? BINARY : CSV;
+}
+
+const char *
+TraceRecorder::GetKindName(uint8_t kind)
+{
+    static const char *names[] = {"allocated", "finished", "preempted", "failed", "depleted"};
+    return kind <= DEPLETED ? names[kind] : "unknown";
+}
+
+TraceRecorder::TraceRecorder()
+    : m_format(CSV)
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    Close();
+}
+
+bool TraceRecorder::Open(const std::string &path, Format format)
+{
+    m_format = format;
+    m_file.open(path, format == BINARY ? std::ios::binary | std::ios::out : std::ios::out);
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+    m_buffer.reserve(BUFFERED_RECORDS);
+    if (m_format == BINARY)
+    {
+        // Header: magic, version and record layout so a reader can check what it got
+        uint32_t recordSize = sizeof(double) + 2 * sizeof(int32_t) + sizeof(uint8_t);
+        m_file.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        m_file.write(reinterpret_cast<const char *>(&BINARY_VERSION), sizeof(BINARY_VERSION));
+        m_file.write(reinterpret_cast<const char *>(&recordSize), sizeof(recordSize));
+    }
+    else
+    {
+        m_file << "time,event,app,worker\n";
+    }
+    return true;
+}
+
+void TraceRecorder::Connect(Ptr<Controller> controller)
+{
+    controller->TraceConnectWithoutContext("AppAllocated", MakeCallback(&TraceRecorder::AppAllocated, this));
+    controller->TraceConnectWithoutContext("AppFinished", MakeCallback(&TraceRecorder::AppFinished, this));
+    controller->TraceConnectWithoutContext("AppPreempted", MakeCallback(&TraceRecorder::AppPreempted, this));
+    controller->TraceConnectWithoutContext("PlacementFailed", MakeCallback(&TraceRecorder::PlacementFailed, this));
+    controller->TraceConnectWithoutContext("WorkerDepleted", MakeCallback(&TraceRecorder::WorkerDepleted, this));
+}
+
+void TraceRecorder::Flush()
+{
+    if (!m_file.is_open())
+    {
+        m_buffer.clear();
+        return;
+    }
+    if (m_format == BINARY)
+    {
+        for (const Record &record : m_buffer)
+        {
+            m_file.write(reinterpret_cast<const char *>(&record.time), sizeof(record.time));
+            m_file.write(reinterpret_cast<const char *>(&record.app), sizeof(record.app));
+            m_file.write(reinterpret_cast<const char *>(&record.worker), sizeof(record.worker));
+            m_file.write(reinterpret_cast<const char *>(&record.kind), sizeof(record.kind));
+        }
+    }
+    else
+    {
+        m_file << std::setprecision(12);
+        for (const Record &record : m_buffer)
+        {
+            m_file << record.time << ',' << GetKindName(record.kind) << ',' << record.app << ','
+                   << record.worker << '\n';
+        }
+    }
+    m_buffer.clear();
+}
+
+void TraceRecorder::Close()
+{
+    Flush();
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+}
+
+void TraceRecorder::Append(Kind kind, int appId, int workerId)
+{
+    m_buffer.push_back(Record{Simulator::Now().GetSeconds(), appId, workerId, kind});
+    if (m_buffer.size() >= BUFFERED_RECORDS)
+    {
+        Flush();
+    }
+}
+
+void TraceRecorder::AppAllocated(int appId, int workerId) { Append(ALLOCATED, appId, workerId); }
+void TraceRecorder::AppFinished(int appId, int workerId) { Append(FINISHED, appId, workerId); }
+void TraceRecorder::AppPreempted(int appId, int workerId) { Append(PREEMPTED, appId, workerId); }
+void TraceRecorder::PlacementFailed(int appId, int workerId) { Append(FAILED, appId, workerId); }
+void TraceRecorder::WorkerDepleted(int workerId) { Append(DEPLETED, 0, workerId); }
+
+} // namespace ns3
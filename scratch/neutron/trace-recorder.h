@@ -0,0 +1,73 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include "controller.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Sink for the Controller trace sources.
+ *
+ * Records are appended to an in-memory buffer and written out in large
+ * blocks, either as CSV (time,event,app,worker) or as fixed-size binary
+ * records preceded by a small header.  Formatting only happens when a block
+ * is written, never while the simulation is handling an event.
+ */
+class TraceRecorder
+{
+public:
+  enum Format
+  {
+    CSV = 0,
+    BINARY
+  };
+
+  enum Kind : uint8_t
+  {
+    ALLOCATED = 0,
+    FINISHED,
+    PREEMPTED,
+    FAILED,
+    DEPLETED
+  };
+
+  struct Record
+  {
+    double time;
+    int32_t app;
+    int32_t worker;
+    uint8_t kind;
+  };
+
+  static Format ParseFormat (const std::string &name);
+  static const char *GetKindName (uint8_t kind);
+
+  TraceRecorder ();
+  ~TraceRecorder ();
+
+  bool Open (const std::string &path, Format format);
+  void Connect (Ptr<Controller> controller);
+  void Flush ();
+  void Close ();
+
+private:
+  void Append (Kind kind, int appId, int workerId);
+  void AppAllocated (int appId, int workerId);
+  void AppFinished (int appId, int workerId);
+  void AppPreempted (int appId, int workerId);
+  void PlacementFailed (int appId, int workerId);
+  void WorkerDepleted (int workerId);
+
+  Format m_format;
+  std::ofstream m_file;
+  std::vector<Record> m_buffer;
+};
+
+} // namespace ns3
+
+#endif // TRACE_RECORDER_H
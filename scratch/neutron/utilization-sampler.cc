@@ -0,0 +1,181 @@
+#include "utilization-sampler.h"
+
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+static const std::size_t BLOCK_BYTES = 4 << 20;
+static const char UTILIZATION_MAGIC[4] = {'N', 'U', 'T', 'L'};
+static const uint32_t UTILIZATION_VERSION = 1;
+
+template <typename T>
+static void WriteColumn(std::ofstream &file, const T *values, std::size_t count)
+{
+    file.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+template <typename T>
+static bool ReadColumn(std::ifstream &file, std::vector<T> &values, std::size_t count)
+{
+    values.resize(count);
+    file.read(reinterpret_cast<char *>(values.data()), count * sizeof(T));
+    return static_cast<std::size_t>(file.gcount()) == count * sizeof(T);
+}
+
+static inline float Used(double remaining, double capacity)
+{
+    return capacity > 0.0 ? static_cast<float>(1.0 - remaining / capacity) : 0.0f;
+}
+
+UtilizationSampler::UtilizationSampler()
+    : m_workers(0),
+      m_blockSamples(1)
+{
+    m_block.samples = 0;
+}
+
+UtilizationSampler::~UtilizationSampler()
+{
+    Close();
+}
+
+bool UtilizationSampler::Open(const std::string &path, Time interval)
+{
+    m_interval = interval;
+    m_file.open(path, std::ios::binary | std::ios::out);
+    return m_file.is_open();
+}
+
+void UtilizationSampler::Attach(Ptr<Controller> controller)
+{
+    m_controllers.push_back(controller);
+}
+
+void UtilizationSampler::Start(Time stop)
+{
+    m_stop = stop;
+    m_workers = 0;
+    for (Ptr<Controller> controller : m_controllers)
+    {
+        m_workers += controller->GetNWorkers();
+    }
+    double interval = m_interval.GetSeconds();
+    m_file.write(UTILIZATION_MAGIC, sizeof(UTILIZATION_MAGIC));
+    WriteColumn(m_file, &UTILIZATION_VERSION, 1);
+    WriteColumn(m_file, &m_workers, 1);
+    WriteColumn(m_file, &interval, 1);
+
+    // Size blocks by bytes so a large pool does not hold thousands of samples in memory
+    std::size_t sampleBytes = sizeof(double) + sizeof(uint32_t) + 4 * sizeof(float) * m_workers;
+    m_blockSamples = std::max<std::size_t>(1, BLOCK_BYTES / sampleBytes);
+    m_block.samples = 0;
+    m_block.time.resize(m_blockSamples);
+    m_block.pending.resize(m_blockSamples);
+    m_block.cpu.resize(std::size_t(m_blockSamples) * m_workers);
+    m_block.memory.resize(std::size_t(m_blockSamples) * m_workers);
+    m_block.storage.resize(std::size_t(m_blockSamples) * m_workers);
+    m_block.power.resize(std::size_t(m_blockSamples) * m_workers);
+    m_event = Simulator::ScheduleNow(&UtilizationSampler::Sample, this);
+}
+
+void UtilizationSampler::Sample()
+{
+    uint32_t k = m_block.samples;
+    uint32_t pending = 0;
+    std::size_t column = k;
+    for (Ptr<Controller> controller : m_controllers)
+    {
+        pending += controller->GetPendingCount();
+        const PlacementEngine &engine = controller->GetEngine();
+        for (uint32_t id = 1; id <= controller->GetNWorkers(); ++id, column += m_blockSamples)
+        {
+            Ptr<CustomNode> node = controller->GetWorker(id);
+            m_block.cpu[column] = Used(engine.GetCpuRemaining(id), node->GetCPU());
+            m_block.memory[column] = Used(engine.GetMemoryRemaining(id), node->GetMemory());
+            m_block.storage[column] = Used(engine.GetStorageRemaining(id), node->GetStorage());
+            m_block.power[column] = node->GetPower();
+        }
+    }
+    m_block.time[k] = Simulator::Now().GetSeconds();
+    m_block.pending[k] = pending;
+    if (++m_block.samples == m_blockSamples)
+    {
+        Flush();
+    }
+    if (Simulator::Now() + m_interval <= m_stop)
+    {
+        m_event = Simulator::Schedule(m_interval, &UtilizationSampler::Sample, this);
+    }
+}
+
+void UtilizationSampler::Flush()
+{
+    uint32_t samples = m_block.samples;
+    if (samples == 0 || !m_file.is_open())
+    {
+        return;
+    }
+    WriteColumn(m_file, &samples, 1);
+    WriteColumn(m_file, m_block.time.data(), samples);
+    WriteColumn(m_file, m_block.pending.data(), samples);
+    // A short last block keeps only the filled part of every worker's series
+    for (const std::vector<float> *values : {&m_block.cpu, &m_block.memory, &m_block.storage, &m_block.power})
+    {
+        for (uint32_t w = 0; w < m_workers; ++w)
+        {
+            WriteColumn(m_file, values->data() + std::size_t(w) * m_blockSamples, samples);
+        }
+    }
+    m_block.samples = 0;
+}
+
+void UtilizationSampler::Close()
+{
+    m_event.Cancel();
+    Flush();
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+}
+
+UtilizationReader::UtilizationReader()
+    : m_workers(0),
+      m_interval(0.0)
+{
+}
+
+bool UtilizationReader::Open(const std::string &path)
+{
+    m_file.open(path, std::ios::binary | std::ios::in);
+    char magic[4];
+    uint32_t version = 0;
+    m_file.read(magic, sizeof(magic));
+    m_file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    m_file.read(reinterpret_cast<char *>(&m_workers), sizeof(m_workers));
+    m_file.read(reinterpret_cast<char *>(&m_interval), sizeof(m_interval));
+    return m_file.good() && std::memcmp(magic, UTILIZATION_MAGIC, sizeof(magic)) == 0 &&
+           version == UTILIZATION_VERSION;
+}
+
+uint32_t UtilizationReader::GetNWorkers() const { return m_workers; }
+double UtilizationReader::GetInterval() const { return m_interval; }
+
+bool UtilizationReader::ReadBlock(UtilizationBlock &block)
+{
+    uint32_t samples = 0;
+    if (!m_file.read(reinterpret_cast<char *>(&samples), sizeof(samples)))
+    {
+        return false;
+    }
+    std::size_t values = std::size_t(samples) * m_workers;
+    block.samples = samples;
+    return ReadColumn(m_file, block.time, samples) && ReadColumn(m_file, block.pending, samples) &&
+           ReadColumn(m_file, block.cpu, values) && ReadColumn(m_file, block.memory, values) &&
+           ReadColumn(m_file, block.storage, values) && ReadColumn(m_file, block.power, values);
+}
+
+} // namespace ns3
@@ -0,0 +1,97 @@
+#ifndef UTILIZATION_SAMPLER_H
+#define UTILIZATION_SAMPLER_H
+
+#include "controller.h"
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * One block of samples as stored in a utilization file.
+ *
+ * time and pending hold one value per sample.  The per-worker columns hold
+ * samples * workers values, worker-major, so the series of one worker is
+ * contiguous: worker index w, sample k is at w * samples + k.  Utilization
+ * is the used fraction of the worker's capacity; power is its battery level.
+ */
+struct UtilizationBlock
+{
+  uint32_t samples;
+  std::vector<double> time;
+  std::vector<uint32_t> pending;
+  std::vector<float> cpu;
+  std::vector<float> memory;
+  std::vector<float> storage;
+  std::vector<float> power;
+};
+
+/**
+ * Samples the worker pool of one or more controllers at a fixed interval
+ * into an append-only columnar binary file.
+ *
+ * Each sample records, for every worker, the used fraction of its CPU,
+ * memory and storage and its battery level, plus the number of applications
+ * waiting for a worker across all controllers.  Samples are kept in memory
+ * and written as one block once a few megabytes have accumulated, so the
+ * sampling event itself only copies numbers.
+ *
+ * File layout (native byte order): magic "NUTL", uint32 version, uint32
+ * worker count and double interval, followed by blocks.  A block is a
+ * uint32 sample count followed by the columns of UtilizationBlock in
+ * declaration order.  Workers are numbered across controllers in the order
+ * they were attached.
+ */
+class UtilizationSampler
+{
+public:
+  UtilizationSampler ();
+  ~UtilizationSampler ();
+
+  bool Open (const std::string &path, Time interval);
+  void Attach (Ptr<Controller> controller);
+  /** Writes the header and samples from now until stop. */
+  void Start (Time stop);
+  void Close ();
+
+private:
+  void Sample ();
+  void Flush ();
+
+  std::ofstream m_file;
+  Time m_interval;
+  Time m_stop;
+  EventId m_event;
+  std::vector<Ptr<Controller>> m_controllers;
+  uint32_t m_workers;
+  uint32_t m_blockSamples;
+  UtilizationBlock m_block;
+};
+
+/** Reads back the blocks of a file written by UtilizationSampler. */
+class UtilizationReader
+{
+public:
+  UtilizationReader ();
+
+  bool Open (const std::string &path);
+  uint32_t GetNWorkers () const;
+  double GetInterval () const;
+  /** Returns false at the end of the file or on a truncated block. */
+  bool ReadBlock (UtilizationBlock &block);
+
+private:
+  std::ifstream m_file;
+  uint32_t m_workers;
+  double m_interval;
+};
+
+} // namespace ns3
+
+#endif // UTILIZATION_SAMPLER_H
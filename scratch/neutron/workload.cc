@@ -0,0 +1,327 @@
+#include "workload.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("Workload");
+
+// Application start times are drawn in [start + START_MIN, start + START_MAX]
+static const double START_MIN = 10.0;
+static const double START_MAX = 3600.0;
+
+static bool IsTopLevelKey(const std::string &line)
+{
+    return !line.empty() && line[0] != ' ' && line[0] != '\t' && line[0] != '#' && line[0] != '-';
+}
+
+bool ScenarioReader::Open(const std::string &path)
+{
+    m_file.open(path);
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+
+    std::string header;
+    std::string line;
+    bool inApplications = false;
+    m_applications = -1;
+    while (std::getline(m_file, line))
+    {
+        if (IsTopLevelKey(line))
+        {
+            inApplications = line.compare(0, 13, "applications:") == 0;
+            if (inApplications)
+            {
+                m_applications = m_file.tellg();
+                continue;
+            }
+        }
+        if (!inApplications)
+        {
+            header += line + "\n";
+        }
+    }
+    m_header = YAML::Load(header);
+    Rewind();
+    return true;
+}
+
+const YAML::Node &ScenarioReader::GetHeader() const
+{
+    return m_header;
+}
+
+void ScenarioReader::Rewind()
+{
+    m_file.clear();
+    m_hasLookahead = false;
+    m_itemIndent = -1;
+    m_done = m_applications == std::streampos(-1);
+    if (!m_done)
+    {
+        m_file.seekg(m_applications);
+    }
+}
+
+bool ScenarioReader::ReadLine(std::string &line)
+{
+    if (m_hasLookahead)
+    {
+        line = m_lookahead;
+        m_hasLookahead = false;
+        return true;
+    }
+    return !m_done && std::getline(m_file, line);
+}
+
+bool ScenarioReader::Next(APP_SPEC &spec)
+{
+    std::string item;
+    std::string line;
+    while (ReadLine(line))
+    {
+        std::size_t indent = line.find_first_not_of(" \t");
+        if (indent == std::string::npos || line[indent] == '#')
+        {
+            continue;
+        }
+        bool isItem = line[indent] == '-' && (indent + 1 == line.size() || line[indent + 1] == ' ');
+        if (isItem && (m_itemIndent < 0 || static_cast<int>(indent) == m_itemIndent))
+        {
+            if (!item.empty())
+            {
+                m_lookahead = line;
+                m_hasLookahead = true;
+                break;
+            }
+            m_itemIndent = indent;
+        }
+        else if (IsTopLevelKey(line))
+        {
+            m_done = true;
+            break;
+        }
+        item += line + "\n";
+    }
+    if (item.empty())
+    {
+        return false;
+    }
+
+    YAML::Node node = YAML::Load(item)[0];
+    spec.POLICY = node["policy"].as<std::string>();
+    spec.START = node["start"].as<float>();
+    spec.DURATION = node["duration"].as<float>();
+    spec.CPU = node["cpu"].as<float>();
+    spec.MEMORY = node["memory"].as<float>();
+    spec.STORAGE = node["storage"].as<float>();
+    return true;
+}
+
+ArrivalGenerator::ArrivalGenerator(Ptr<Controller> controller)
+    : ArrivalGenerator(MakeCallback(&Controller::AddApp, controller), MakeCallback(&Controller::AllocateApp, controller))
+{
+}
+
+ArrivalGenerator::ArrivalGenerator(Ptr<Broker> broker)
+    : ArrivalGenerator(MakeCallback(&Broker::AddApp, broker), MakeCallback(&Broker::AllocateApp, broker))
+{
+}
+
+ArrivalGenerator::ArrivalGenerator(AddAppCallback addApp, Callback<void, int> allocateApp)
+    : m_addApp(addApp),
+      m_allocateApp(allocateApp),
+      m_reader(nullptr),
+      m_window(Seconds(3600)),
+      m_synthetic(false),
+      m_rate(0.0),
+      m_count(0),
+      m_nextSynthetic(0.0),
+      m_hasLookahead(false),
+      m_exhausted(false),
+      m_generated(0)
+{
+    m_startRv = CreateObject<UniformRandomVariable>();
+    m_durationRv = CreateObject<NormalRandomVariable>();
+    m_interArrivalRv = CreateObject<ExponentialRandomVariable>();
+    m_templateRv = CreateObject<UniformRandomVariable>();
+}
+
+void ArrivalGenerator::SetWindow(Time window)
+{
+    m_window = window;
+}
+
+void ArrivalGenerator::SetSynthetic(double rate, uint64_t count)
+{
+    m_synthetic = true;
+    m_rate = rate;
+    m_count = count;
+}
+
+int64_t ArrivalGenerator::AssignStreams(int64_t stream)
+{
+    m_startRv->SetStream(stream);
+    m_durationRv->SetStream(stream + 1);
+    m_interArrivalRv->SetStream(stream + 2);
+    m_templateRv->SetStream(stream + 3);
+    return 4;
+}
+
+uint64_t ArrivalGenerator::GetGenerated() const
+{
+    return m_generated;
+}
+
+void ArrivalGenerator::Start(ScenarioReader *reader)
+{
+    m_reader = reader;
+    if (m_synthetic)
+    {
+        LoadTemplates();
+        m_nextSynthetic = m_interArrivalRv->GetValue(1.0 / m_rate, 0.0);
+    }
+    Refill();
+}
+
+void ArrivalGenerator::Refill()
+{
+    double now = Simulator::Now().GetSeconds();
+    double horizon = now + m_window.GetSeconds();
+    if (m_synthetic)
+    {
+        FillSynthetic(horizon);
+    }
+    else
+    {
+        FillFromReader(horizon);
+    }
+
+    while (!m_arrivals.empty() && std::get<0>(m_arrivals.top()) <= horizon)
+    {
+        double start = std::get<0>(m_arrivals.top());
+        int appId = std::get<1>(m_arrivals.top());
+        m_arrivals.pop();
+        if (start < now)
+        {
+            NS_LOG_WARN("Application " << appId << " starts at " << start << "s, before the current window; "
+                        "the input is not sorted by start");
+            start = now;
+        }
+        Simulator::Schedule(Seconds(start) - Simulator::Now(), &ArrivalGenerator::Arrive, this, appId);
+    }
+
+    if (m_exhausted && m_arrivals.empty())
+    {
+        return;
+    }
+    // Skip windows in which nothing is known to arrive
+    double next = horizon;
+    if (!m_arrivals.empty())
+    {
+        next = std::max(next, std::get<0>(m_arrivals.top()) - m_window.GetSeconds());
+    }
+    else if (m_synthetic)
+    {
+        next = std::max(next, m_nextSynthetic - m_window.GetSeconds());
+    }
+    else if (m_hasLookahead)
+    {
+        next = std::max(next, m_lookahead.START + START_MIN - m_window.GetSeconds());
+    }
+    Simulator::Schedule(Seconds(next) - Simulator::Now(), &ArrivalGenerator::Refill, this);
+}
+
+void ArrivalGenerator::FillFromReader(double horizon)
+{
+    while (true)
+    {
+        if (!m_hasLookahead)
+        {
+            if (!m_reader->Next(m_lookahead))
+            {
+                m_exhausted = true;
+                break;
+            }
+            m_hasLookahead = true;
+        }
+        if (m_lookahead.START + START_MIN > horizon)
+        {
+            break;
+        }
+        float start = m_startRv->GetValue(m_lookahead.START + START_MIN, m_lookahead.START + START_MAX);
+        float duration = DrawDuration(m_lookahead.DURATION);
+        int appId = Register(m_lookahead, start, duration);
+        m_arrivals.push(Arrival(start, appId));
+        m_hasLookahead = false;
+    }
+}
+
+void ArrivalGenerator::FillSynthetic(double horizon)
+{
+    while (m_generated < m_count && m_nextSynthetic <= horizon && !m_templates.empty())
+    {
+        double pick = m_templateRv->GetValue(0.0, m_templateWeights.back());
+        std::size_t index = std::upper_bound(m_templateWeights.begin(), m_templateWeights.end(), pick) -
+                            m_templateWeights.begin();
+        const APP_SPEC &spec = m_templates[std::min(index, m_templates.size() - 1)];
+        float duration = DrawDuration(spec.DURATION);
+        int appId = Register(spec, m_nextSynthetic, duration);
+        m_arrivals.push(Arrival(m_nextSynthetic, appId));
+        m_nextSynthetic += m_interArrivalRv->GetValue(1.0 / m_rate, 0.0);
+    }
+    if (m_generated >= m_count || m_templates.empty())
+    {
+        m_exhausted = true;
+    }
+}
+
+// The application mix of the file, weighted by how often each kind appears
+void ArrivalGenerator::LoadTemplates()
+{
+    std::map<std::tuple<std::string, float, float, float, float>, uint64_t> counts;
+    APP_SPEC spec;
+    m_reader->Rewind();
+    while (m_reader->Next(spec))
+    {
+        counts[std::make_tuple(spec.POLICY, spec.DURATION, spec.CPU, spec.MEMORY, spec.STORAGE)]++;
+    }
+    double total = 0.0;
+    for (const auto &entry : counts)
+    {
+        APP_SPEC kind;
+        std::tie(kind.POLICY, kind.DURATION, kind.CPU, kind.MEMORY, kind.STORAGE) = entry.first;
+        kind.START = 0.0;
+        total += entry.second;
+        m_templates.push_back(kind);
+        m_templateWeights.push_back(total);
+    }
+}
+
+float ArrivalGenerator::DrawDuration(float mean)
+{
+    float duration = 0.0;
+    float variance = (mean * 0.20) * (mean * 0.20);
+    while (duration <= 0.0)
+    {
+        duration = m_durationRv->GetValue(mean, variance);
+    }
+    return duration;
+}
+
+int ArrivalGenerator::Register(const APP_SPEC &spec, float start, float duration)
+{
+    m_generated++;
+    return m_addApp(spec.POLICY, start, duration, spec.CPU, spec.MEMORY, spec.STORAGE);
+}
+
+void ArrivalGenerator::Arrive(int appId)
+{
+    m_allocateApp(appId);
+}
+
+} // namespace ns3
@@ -0,0 +1,123 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "broker.h"
+#include "controller.h"
+#include "ns3/random-variable-stream.h"
+#include <yaml-cpp/yaml.h>
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace ns3 {
+
+struct APP_SPEC
+{
+    std::string POLICY;
+    float START;
+    float DURATION;
+    float CPU;
+    float MEMORY;
+    float STORAGE;
+};
+
+/**
+ * Reads a scenario YAML file without holding the application list in memory.
+ *
+ * Every top-level section except "applications" is parsed as usual and is
+ * available through GetHeader().  The block sequence under "applications"
+ * is read one item at a time by Next(), so the memory used does not depend
+ * on the number of applications in the file.
+ */
+class ScenarioReader
+{
+public:
+    bool Open(const std::string &path);
+    const YAML::Node &GetHeader() const;
+    bool Next(APP_SPEC &spec);
+    void Rewind();
+
+private:
+    bool ReadLine(std::string &line);
+
+    std::ifstream m_file;
+    YAML::Node m_header;
+    std::streampos m_applications;
+    std::string m_lookahead;
+    int m_itemIndent;
+    bool m_hasLookahead;
+    bool m_done;
+};
+
+/**
+ * Feeds applications to the controller in start-time order, one window of
+ * simulated time at a time.
+ *
+ * Applications go to a single controller or, in the hierarchical mode, to
+ * the broker.  They are either read from a ScenarioReader (the file is
+ * expected to list them by non-decreasing "start") or synthesized as a
+ * Poisson process that draws from the mix of applications found in the
+ * file.  Only arrivals inside the current window are registered and
+ * scheduled, so the event queue and the generator's memory stay bounded
+ * however long the workload is.  A single set of random streams is used for
+ * every application; AssignStreams makes runs reproducible.
+ */
+class ArrivalGenerator
+{
+public:
+    typedef Callback<int, std::string, float, float, double, double, double> AddAppCallback;
+
+    ArrivalGenerator(Ptr<Controller> controller);
+    ArrivalGenerator(Ptr<Broker> broker);
+    ArrivalGenerator(AddAppCallback addApp, Callback<void, int> allocateApp);
+
+    void SetWindow(Time window);
+    void SetSynthetic(double rate, uint64_t count);
+    int64_t AssignStreams(int64_t stream);
+    void Start(ScenarioReader *reader);
+    uint64_t GetGenerated() const;
+
+private:
+    typedef std::tuple<double, int> Arrival;
+
+    void Refill();
+    void FillFromReader(double horizon);
+    void FillSynthetic(double horizon);
+    void LoadTemplates();
+    float DrawDuration(float mean);
+    int Register(const APP_SPEC &spec, float start, float duration);
+    void Arrive(int appId);
+
+    AddAppCallback m_addApp;
+    Callback<void, int> m_allocateApp;
+    ScenarioReader *m_reader;
+    Time m_window;
+
+    bool m_synthetic;
+    double m_rate;
+    uint64_t m_count;
+    double m_nextSynthetic;
+    std::vector<APP_SPEC> m_templates;
+    std::vector<double> m_templateWeights;
+
+    APP_SPEC m_lookahead;
+    bool m_hasLookahead;
+    bool m_exhausted;
+    uint64_t m_generated;
+    std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>> m_arrivals;
+
+    Ptr<UniformRandomVariable> m_startRv;
+    Ptr<NormalRandomVariable> m_durationRv;
+    Ptr<ExponentialRandomVariable> m_interArrivalRv;
+    Ptr<UniformRandomVariable> m_templateRv;
+};
+
+} // namespace ns3
+
+#endif // WORKLOAD_H
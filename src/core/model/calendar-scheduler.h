@@ -99,6 +99,7 @@ class CalendarScheduler : public Scheduler
     Scheduler::Event PeekNext() const override;
     Scheduler::Event RemoveNext() override;
     void Remove(const Scheduler::Event& ev) override;
+    void RemoveCancelled(std::vector<Scheduler::Event>& removed) override;
 
   private:
     /** Double the number of buckets if necessary. */
@@ -0,0 +1,236 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "dary-heap-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+
+/**
+ * @file
+ * @ingroup scheduler
+ * ns3::DaryHeapScheduler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(DaryHeapScheduler);
+
+TypeId
+DaryHeapScheduler::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::DaryHeapScheduler")
+                            .SetParent<Scheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<DaryHeapScheduler>();
+    return tid;
+}
+
+DaryHeapScheduler::DaryHeapScheduler()
+{
+    NS_LOG_FUNCTION(this);
+    m_keys.resize(KEY_OFFSET);
+}
+
+DaryHeapScheduler::~DaryHeapScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+DaryHeapScheduler::Key
+DaryHeapScheduler::MakeKey(const EventKey& key)
+{
+#ifdef __SIZEOF_INT128__
+    return (Key(key.m_ts) << 64) | key.m_uid;
+#else
+    return Key{key.m_ts, key.m_uid};
+#endif
+}
+
+Scheduler::Event
+DaryHeapScheduler::ToEvent(const Key& key, const Payload& payload)
+{
+    Event ev;
+    ev.impl = payload.impl;
+#ifdef __SIZEOF_INT128__
+    ev.key.m_ts = static_cast<uint64_t>(key >> 64);
+    ev.key.m_uid = static_cast<uint32_t>(key);
+#else
+    ev.key.m_ts = key.ts;
+    ev.key.m_uid = static_cast<uint32_t>(key.uid);
+#endif
+    ev.key.m_context = payload.context;
+    return ev;
+}
+
+void
+DaryHeapScheduler::SiftUp(std::size_t index, const Key& key, const Payload& payload)
+{
+    Key* keys = m_keys.data() + KEY_OFFSET;
+    while (index > 0)
+    {
+        std::size_t parent = (index - 1) / ARITY;
+        if (!(key < keys[parent]))
+        {
+            break;
+        }
+        keys[index] = keys[parent];
+        m_payloads[index] = m_payloads[parent];
+        index = parent;
+    }
+    keys[index] = key;
+    m_payloads[index] = payload;
+}
+
+void
+DaryHeapScheduler::SiftDown(std::size_t index, const Key& key, const Payload& payload)
+{
+    Key* keys = m_keys.data() + KEY_OFFSET;
+    std::size_t size = m_payloads.size();
+    while (true)
+    {
+        std::size_t first = index * ARITY + 1;
+        if (first >= size)
+        {
+            break;
+        }
+        std::size_t smallest = first;
+        if (first + ARITY <= size)
+        {
+            // All the children are there, in one cache line
+            for (std::size_t child = first + 1; child < first + ARITY; child++)
+            {
+                smallest = keys[child] < keys[smallest] ? child : smallest;
+            }
+        }
+        else
+        {
+            for (std::size_t child = first + 1; child < size; child++)
+            {
+                smallest = keys[child] < keys[smallest] ? child : smallest;
+            }
+        }
+        if (!(keys[smallest] < key))
+        {
+            break;
+        }
+        keys[index] = keys[smallest];
+        m_payloads[index] = m_payloads[smallest];
+        index = smallest;
+    }
+    keys[index] = key;
+    m_payloads[index] = payload;
+}
+
+void
+DaryHeapScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    std::size_t index = m_payloads.size();
+    m_keys.emplace_back();
+    m_payloads.emplace_back();
+    SiftUp(index, MakeKey(ev.key), Payload{ev.impl, ev.key.m_context});
+}
+
+bool
+DaryHeapScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_payloads.empty();
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return ToEvent(m_keys[KEY_OFFSET], m_payloads[0]);
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Event next = ToEvent(m_keys[KEY_OFFSET], m_payloads[0]);
+    Key lastKey = m_keys.back();
+    Payload lastPayload = m_payloads.back();
+    m_keys.pop_back();
+    m_payloads.pop_back();
+    if (!m_payloads.empty())
+    {
+        SiftDown(0, lastKey, lastPayload);
+    }
+    return next;
+}
+
+void
+DaryHeapScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    Key key = MakeKey(ev.key);
+    for (std::size_t i = KEY_OFFSET; i < m_keys.size(); i++)
+    {
+        if (!(m_keys[i] < key) && !(key < m_keys[i]))
+        {
+            std::size_t index = i - KEY_OFFSET;
+            NS_ASSERT(m_payloads[index].impl == ev.impl);
+            Key lastKey = m_keys.back();
+            Payload lastPayload = m_payloads.back();
+            m_keys.pop_back();
+            m_payloads.pop_back();
+            if (index == m_payloads.size())
+            {
+                return;
+            }
+            // The last event may belong above or below the removed one
+            if (index > 0 && lastKey < m_keys[KEY_OFFSET + (index - 1) / ARITY])
+            {
+                SiftUp(index, lastKey, lastPayload);
+            }
+            else
+            {
+                SiftDown(index, lastKey, lastPayload);
+            }
+            return;
+        }
+    }
+    NS_ASSERT(false);
+}
+
+void
+DaryHeapScheduler::RemoveCancelled(std::vector<Event>& removed)
+{
+    NS_LOG_FUNCTION(this);
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < m_payloads.size(); i++)
+    {
+        if (m_payloads[i].impl->IsCancelled())
+        {
+            removed.push_back(ToEvent(m_keys[KEY_OFFSET + i], m_payloads[i]));
+        }
+        else
+        {
+            m_keys[KEY_OFFSET + size] = m_keys[KEY_OFFSET + i];
+            m_payloads[size] = m_payloads[i];
+            size++;
+        }
+    }
+    m_keys.resize(KEY_OFFSET + size);
+    m_payloads.resize(size);
+    // Floyd's heap construction, from the last parent up to the root
+    for (std::size_t i = size > 1 ? (size - 2) / ARITY + 1 : 0; i-- > 0;)
+    {
+        // SiftDown overwrites the hole, so pass it copies
+        Key key = m_keys[KEY_OFFSET + i];
+        Payload payload = m_payloads[i];
+        SiftDown(i, key, payload);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,214 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup scheduler
+ * ns3::DaryHeapScheduler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup scheduler
+ * @brief a cache-friendly 4-ary heap event scheduler
+ *
+ * This is an implicit heap like HeapScheduler, but each node has four
+ * children instead of two, which halves the depth of the tree, and the
+ * sort keys are kept apart from the rest of the events:
+ *
+ *  - the keys array holds, for each event, its timestamp and unique id
+ *    packed in a single 128-bit integer, so comparing two events is a
+ *    single integer comparison;
+ *  - the payload array holds, at the same index, the EventImpl pointer
+ *    and the context, which are only moved, never read, while sifting.
+ *
+ * The keys array is aligned so the four children of a node share one
+ * 64-byte cache line: sifting an event down reads one cache line per
+ * level, and a heap of a million events is only ten levels deep.
+ *
+ * @par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | Logarithmic     | Sift up
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Heap kept sorted
+ * Remove()     | Linear          | Search of the keys, sift
+ * RemoveNext() | Logarithmic     | Sift down
+ *
+ * @par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 6 x `sizeof (*)`<br/>(48 bytes)  | Two `std::vector`
+ * Per Event | 0                                | Keys and payloads stored in `std::vector` directly
+ */
+class DaryHeapScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    DaryHeapScheduler();
+    /** Destructor. */
+    ~DaryHeapScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+    void RemoveCancelled(std::vector<Scheduler::Event>& removed) override;
+
+  private:
+#ifdef __SIZEOF_INT128__
+    /** Sort key: the timestamp in the high 64 bits, the unique id in the low ones. */
+    typedef __uint128_t Key;
+#else
+    /** Sort key: the timestamp and the unique id, compared in that order. */
+    struct Key
+    {
+        uint64_t ts;  /**< Event time stamp. */
+        uint64_t uid; /**< Event unique id. */
+
+        /**
+         * Compare (less than) two keys.
+         * @param [in] other The other key.
+         * @returns \c true if this key is smaller.
+         */
+        bool operator<(const Key& other) const
+        {
+            return ts < other.ts || (ts == other.ts && uid < other.uid);
+        }
+    };
+#endif
+
+    /** The parts of an event not needed to order it. */
+    struct Payload
+    {
+        EventImpl* impl;  /**< Pointer to the event implementation. */
+        uint32_t context; /**< Event context. */
+    };
+
+    /**
+     * Allocator of storage aligned on cache lines.
+     * @tparam T The type of the elements.
+     */
+    template <typename T>
+    struct CacheAlignedAllocator
+    {
+        /** The type of the elements. */
+        typedef T value_type;
+
+        /** Constructor. */
+        CacheAlignedAllocator() = default;
+
+        /**
+         * Copy from an allocator of another type.
+         * @tparam U The type of the elements of the other allocator.
+         */
+        template <typename U>
+        CacheAlignedAllocator(const CacheAlignedAllocator<U>&)
+        {
+        }
+
+        /**
+         * Allocate storage.
+         * @param [in] n The number of elements.
+         * @returns The storage.
+         */
+        T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{CACHE_LINE}));
+        }
+
+        /**
+         * Release storage.
+         * @param [in] p The storage.
+         */
+        void deallocate(T* p, std::size_t)
+        {
+            ::operator delete(p, std::align_val_t{CACHE_LINE});
+        }
+
+        /**
+         * Compare two allocators.
+         * @tparam U The type of the elements of the other allocator.
+         * @returns \c true: all allocators are interchangeable.
+         */
+        template <typename U>
+        bool operator==(const CacheAlignedAllocator<U>&) const
+        {
+            return true;
+        }
+    };
+
+    /** Number of children of each node. */
+    static constexpr std::size_t ARITY = 4;
+    /** Size of a cache line. */
+    static constexpr std::size_t CACHE_LINE = 64;
+    /**
+     * Number of unused keys at the start of the keys array, so the
+     * children of every node start on a cache line.
+     */
+    static constexpr std::size_t KEY_OFFSET = ARITY - 1;
+
+    /**
+     * Make the sort key of an event.
+     *
+     * @param [in] key The event key.
+     * @returns The sort key.
+     */
+    static inline Key MakeKey(const Scheduler::EventKey& key);
+    /**
+     * Make an event from its sort key and payload.
+     *
+     * @param [in] key The sort key.
+     * @param [in] payload The payload.
+     * @returns The event.
+     */
+    static inline Scheduler::Event ToEvent(const Key& key, const Payload& payload);
+    /**
+     * Move an event towards the root until the heap is ordered again.
+     *
+     * @param [in] index The index of a hole in the heap.
+     * @param [in] key The sort key of the event to place in the hole.
+     * @param [in] payload The payload of the event to place in the hole.
+     */
+    void SiftUp(std::size_t index, const Key& key, const Payload& payload);
+    /**
+     * Move an event towards the leaves until the heap is ordered again.
+     *
+     * @param [in] index The index of a hole in the heap.
+     * @param [in] key The sort key of the event to place in the hole.
+     * @param [in] payload The payload of the event to place in the hole.
+     */
+    void SiftDown(std::size_t index, const Key& key, const Payload& payload);
+
+    /** The sort keys, at index `i + KEY_OFFSET` for the event of index `i`. */
+    std::vector<Key, CacheAlignedAllocator<Key>> m_keys;
+    /** The payloads, at the index of the event. */
+    std::vector<Payload> m_payloads;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
@@ -9,11 +9,13 @@
 #include "default-simulator-impl.h"
 
 #include "assert.h"
+#include "double.h"
 #include "log.h"
 #include "scheduler.h"
 #include "simulator.h"
 
 #include <cmath>
+#include <vector>
 
 /**
  * @file
@@ -37,7 +39,16 @@ DefaultSimulatorImpl::GetTypeId()
     static TypeId tid = TypeId("ns3::DefaultSimulatorImpl")
                             .SetParent<SimulatorImpl>()
                             .SetGroupName("Core")
-                            .AddConstructor<DefaultSimulatorImpl>();
+                            .AddConstructor<DefaultSimulatorImpl>()
+                            .AddAttribute("CompactionThreshold",
+                                          "The fraction of the pending events which, once "
+                                          "cancelled, are purged from the scheduler "
+                                          "(1 to never purge them).  Only this "
+                                          "implementation purges cancelled events.",
+                                          DoubleValue(0.5),
+                                          MakeDoubleAccessor(
+                                              &DefaultSimulatorImpl::m_compactionThreshold),
+                                          MakeDoubleChecker<double>(0, 1));
     return tid;
 }
 
@@ -50,6 +61,9 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
     m_currentTs = 0;
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
+    m_cancelledEvents = 0;
+    m_compactionThreshold = 0.5;
+    m_compactionCount = 0;
     m_eventCount = 0;
     m_eventsWithContextEmpty = true;
     m_mainThreadId = std::this_thread::get_id();
@@ -125,6 +139,10 @@ DefaultSimulatorImpl::ProcessOneEvent()
     NS_ASSERT(next.key.m_ts >= m_currentTs);
     m_unscheduledEvents--;
     m_eventCount++;
+    if (m_cancelledEvents > 0 && next.impl->IsCancelled())
+    {
+        m_cancelledEvents--;
+    }
 
     NS_LOG_LOGIC("handle " << next.key.m_ts);
     m_currentTs = next.key.m_ts;
@@ -341,7 +359,34 @@ DefaultSimulatorImpl::Cancel(const EventId& id)
     if (!IsExpired(id))
     {
         id.PeekEventImpl()->Cancel();
+        if (id.GetUid() == EventId::UID::DESTROY)
+        {
+            return;
+        }
+        // Purge the cancelled events once they clog the scheduler
+        m_cancelledEvents++;
+        if (m_cancelledEvents >= COMPACTION_MIN_EVENTS &&
+            m_cancelledEvents > m_compactionThreshold * m_unscheduledEvents)
+        {
+            Compact();
+        }
+    }
+}
+
+void
+DefaultSimulatorImpl::Compact()
+{
+    NS_LOG_FUNCTION(this << m_cancelledEvents << m_unscheduledEvents);
+    std::vector<Scheduler::Event> removed;
+    m_events->RemoveCancelled(removed);
+    for (const auto& ev : removed)
+    {
+        // whenever we remove an event from the event list, we have to unref it.
+        ev.impl->Unref();
     }
+    m_unscheduledEvents -= removed.size();
+    m_cancelledEvents = 0;
+    m_compactionCount++;
 }
 
 bool
@@ -386,4 +431,22 @@ DefaultSimulatorImpl::GetEventCount() const
     return m_eventCount;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetLiveEventCount() const
+{
+    return m_unscheduledEvents - m_cancelledEvents;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetCancelledEventCount() const
+{
+    return m_cancelledEvents;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetCompactionCount() const
+{
+    return m_compactionCount;
+}
+
 } // namespace ns3
@@ -67,6 +67,29 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
 
+    /**
+     * Get the number of events pending in the scheduler which have not
+     * been cancelled.
+     *
+     * @returns The number of live events.
+     */
+    uint64_t GetLiveEventCount() const;
+    /**
+     * Get the number of cancelled events still held by the scheduler.
+     *
+     * Cancelled events are purged when they exceed the CompactionThreshold
+     * fraction of the pending events.
+     *
+     * @returns The number of cancelled events.
+     */
+    uint64_t GetCancelledEventCount() const;
+    /**
+     * Get the number of times the cancelled events have been purged.
+     *
+     * @returns The number of compactions.
+     */
+    uint64_t GetCompactionCount() const;
+
   private:
     void DoDispose() override;
 
@@ -74,6 +97,11 @@ class DefaultSimulatorImpl : public SimulatorImpl
     void ProcessOneEvent();
     /** Move events from a different context into the main event queue. */
     void ProcessEventsWithContext();
+    /** Remove the cancelled events from the scheduler and release them. */
+    void Compact();
+
+    /** Smallest number of cancelled events worth a compaction. */
+    static constexpr uint64_t COMPACTION_MIN_EVENTS = 1024;
 
     /** Wrap an event with its execution context. */
     struct EventWithContext
@@ -122,6 +150,12 @@ class DefaultSimulatorImpl : public SimulatorImpl
      *  not counting the Destroy events; this is used for validation
      */
     int m_unscheduledEvents;
+    /** Number of cancelled events among the unscheduled events. */
+    uint64_t m_cancelledEvents;
+    /** Fraction of cancelled unscheduled events triggering a compaction. */
+    double m_compactionThreshold;
+    /** Number of compactions. */
+    uint64_t m_compactionCount;
 
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
@@ -27,6 +27,14 @@ namespace ns3
 /* static */
 std::string DesMetrics::m_outputDir; // = "";
 
+std::atomic<uint64_t> DesMetrics::m_eventAllocations = 0;
+
+uint64_t
+DesMetrics::GetEventAllocations()
+{
+    return m_eventAllocations.load(std::memory_order_relaxed);
+}
+
 void
 DesMetrics::Initialize(std::vector<std::string> args, std::string outDir /* = "" */)
 {
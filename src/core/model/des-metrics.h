@@ -18,6 +18,7 @@
 #include "nstime.h"
 #include "singleton.h"
 
+#include <atomic>
 #include <fstream>
 #include <mutex>
 #include <stdint.h> // uint32_t
@@ -126,6 +127,22 @@ class DesMetrics : public Singleton<DesMetrics>
      */
     void TraceWithContext(uint32_t context, const Time& now, const Time& delay);
 
+    /**
+     * Get the number of events whose storage was allocated from the heap.
+     *
+     * EventImpl recycles the storage of destroyed events, so this only grows
+     * while the number of pending events grows, whether or not DES Metrics
+     * is enabled.
+     * @returns The number of heap allocations of events.
+     */
+    static uint64_t GetEventAllocations();
+
+    /** Count a heap allocation of an event. */
+    static void RecordEventAllocation()
+    {
+        m_eventAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
     /**
      * Destructor, closes the trace file.
      */
@@ -143,6 +160,9 @@ class DesMetrics : public Singleton<DesMetrics>
      */
     static std::string m_outputDir;
 
+    /** Heap allocations of events, for every thread. */
+    static std::atomic<uint64_t> m_eventAllocations;
+
     bool m_initialized; //!< Have we been initialized.
     std::ofstream m_os; //!< The output JSON trace file stream.
     char m_separator;   //!< The separator between event records.
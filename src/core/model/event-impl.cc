@@ -8,8 +8,12 @@
 
 #include "event-impl.h"
 
+#include "des-metrics.h"
 #include "log.h"
 
+#include <algorithm>
+#include <new>
+
 /**
  * @file
  * @ingroup events
@@ -21,6 +25,124 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+namespace
+{
+
+/** Granularity of the event size classes, in bytes. */
+constexpr std::size_t EVENT_SIZE_STEP = 16;
+/** Number of event size classes; larger events are not pooled. */
+constexpr std::size_t EVENT_SIZE_CLASSES = 16;
+
+/** The storage of a destroyed event, in the free list of its size class. */
+struct FreeEvent
+{
+    FreeEvent* next; //!< Next free event of the same size class.
+};
+
+/**
+ * The free lists of a thread.
+ *
+ * This is trivially destructible, so events destroyed while the thread
+ * exits, after its free lists were released, can still check \c released.
+ */
+struct EventPool
+{
+    FreeEvent* free[EVENT_SIZE_CLASSES];  //!< Free events, by size class.
+    std::size_t count[EVENT_SIZE_CLASSES]; //!< Length of the free lists.
+    std::size_t owned[EVENT_SIZE_CLASSES]; //!< Events allocated from the heap, by size class.
+    bool armed;                            //!< Whether the releaser is registered.
+    bool released;                       //!< Whether the free lists were released.
+};
+
+/** The free lists of the calling thread. */
+thread_local EventPool t_pool{};
+
+/** Returns the free events of a thread to the heap when the thread exits. */
+struct EventPoolReleaser
+{
+    ~EventPoolReleaser()
+    {
+        for (auto& head : t_pool.free)
+        {
+            while (head != nullptr)
+            {
+                FreeEvent* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+        t_pool.released = true;
+    }
+};
+
+/** Releases the free lists of the calling thread. */
+thread_local EventPoolReleaser t_releaser;
+
+/**
+ * Get the size class of an event.
+ * @param [in] size The size of the event.
+ * @returns The size class, EVENT_SIZE_CLASSES or more if it is not pooled.
+ */
+inline std::size_t
+SizeClass(std::size_t size)
+{
+    return (size - 1) / EVENT_SIZE_STEP;
+}
+
+} // unnamed namespace
+
+void*
+EventImpl::operator new(std::size_t size)
+{
+    std::size_t sizeClass = SizeClass(size);
+    if (sizeClass < EVENT_SIZE_CLASSES && !t_pool.released)
+    {
+        FreeEvent* event = t_pool.free[sizeClass];
+        if (event != nullptr)
+        {
+            t_pool.free[sizeClass] = event->next;
+            t_pool.count[sizeClass]--;
+            return event;
+        }
+        // Round up, so the storage can be reused by any event of the class
+        size = (sizeClass + 1) * EVENT_SIZE_STEP;
+        t_pool.owned[sizeClass]++;
+    }
+    DesMetrics::RecordEventAllocation();
+    return ::operator new(size);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size)
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+    std::size_t sizeClass = SizeClass(size);
+    // A thread only ever frees as many events as it allocated, unless events
+    // allocated by another thread are destroyed here, as the multithreaded
+    // simulator does with events scheduled across partitions.  Those only
+    // fill the free list up to POOL_CAPACITY, so it cannot grow for the
+    // whole run while the other thread keeps allocating.
+    if (sizeClass >= EVENT_SIZE_CLASSES || t_pool.released ||
+        t_pool.count[sizeClass] >= std::max(POOL_CAPACITY, t_pool.owned[sizeClass]))
+    {
+        ::operator delete(p);
+        return;
+    }
+    if (!t_pool.armed)
+    {
+        // The first use of t_releaser registers its destructor for this thread
+        t_pool.armed = true;
+        [[maybe_unused]] EventPoolReleaser* releaser = &t_releaser;
+    }
+    auto event = static_cast<FreeEvent*>(p);
+    event->next = t_pool.free[sizeClass];
+    t_pool.free[sizeClass] = event;
+    t_pool.count[sizeClass]++;
+}
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -10,6 +10,7 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -56,6 +57,35 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * Allocate the storage of an event.
+     *
+     * The storage of destroyed events is kept in free lists, one per thread
+     * and per size class, and reused for the next events of the same size
+     * class, so that once the number of pending events stops growing,
+     * scheduling an event no longer allocates from the heap.  Events larger
+     * than the largest size class are always allocated from the heap.
+     * DesMetrics::GetEventAllocations() counts the heap allocations.
+     *
+     * A free list holds at most as many events as its thread allocated
+     * from the heap, or POOL_CAPACITY if that is larger; the storage of
+     * events destroyed beyond that goes back to the heap.
+     *
+     * @param [in] size The size of the event.
+     * @returns The storage of the event.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Return the storage of an event to the free list of the calling thread.
+     *
+     * @param [in] p The storage of the event.
+     * @param [in] size The size of the event.
+     */
+    static void operator delete(void* p, std::size_t size);
+
+    /** Number of events a free list holds at least before it returns storage to the heap. */
+    static constexpr std::size_t POOL_CAPACITY = 1024;
+
   protected:
     /**
      * Implementation for Invoke().
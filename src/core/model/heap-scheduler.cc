@@ -232,4 +232,28 @@ HeapScheduler::Remove(const Event& ev)
     NS_ASSERT(false);
 }
 
+void
+HeapScheduler::RemoveCancelled(std::vector<Event>& removed)
+{
+    NS_LOG_FUNCTION(this);
+    std::size_t last = Root();
+    for (std::size_t i = Root(); i < m_heap.size(); i++)
+    {
+        if (m_heap[i].impl->IsCancelled())
+        {
+            removed.push_back(m_heap[i]);
+        }
+        else
+        {
+            m_heap[last++] = m_heap[i];
+        }
+    }
+    m_heap.resize(last);
+    // Floyd's heap construction, from the last parent up to the root
+    for (std::size_t i = Parent(Last()); i >= Root(); i--)
+    {
+        TopDown(i);
+    }
+}
+
 } // namespace ns3
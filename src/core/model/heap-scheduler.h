@@ -79,6 +79,7 @@ class HeapScheduler : public Scheduler
     Scheduler::Event PeekNext() const override;
     Scheduler::Event RemoveNext() override;
     void Remove(const Scheduler::Event& ev) override;
+    void RemoveCancelled(std::vector<Scheduler::Event>& removed) override;
 
   private:
     /** Event list type:  vector of Events, managed as a heap. */
@@ -0,0 +1,365 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ladder-queue-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <algorithm>
+#include <functional>
+
+/**
+ * @file
+ * @ingroup scheduler
+ * ns3::LadderQueueScheduler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderQueueScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderQueueScheduler);
+
+TypeId
+LadderQueueScheduler::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::LadderQueueScheduler")
+                            .SetParent<Scheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<LadderQueueScheduler>();
+    return tid;
+}
+
+LadderQueueScheduler::LadderQueueScheduler()
+    : m_topMin(0),
+      m_topMax(0),
+      m_topStart(0),
+      m_rungs(MAX_RUNGS),
+      m_nRungs(0),
+      m_size(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderQueueScheduler::~LadderQueueScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint64_t
+LadderQueueScheduler::CurrentStart(const Rung& rung) const
+{
+    return rung.start + rung.current * rung.width;
+}
+
+LadderQueueScheduler::Rung&
+LadderQueueScheduler::AddRung(uint64_t start, uint64_t end, std::size_t nEvents)
+{
+    NS_LOG_FUNCTION(this << start << end << nEvents);
+    NS_ASSERT(m_nRungs < MAX_RUNGS);
+    NS_ASSERT(start < end);
+
+    // m_rungs never grows, so references to the other rungs stay valid
+    Rung& rung = m_rungs[m_nRungs++];
+    uint64_t span = end - start;
+    std::size_t nBuckets = std::max<std::size_t>(1, std::min<uint64_t>(nEvents, MAX_BUCKETS));
+    nBuckets = std::min<uint64_t>(nBuckets, span);
+    rung.start = start;
+    rung.width = (span + nBuckets - 1) / nBuckets;
+    rung.nBuckets = nBuckets;
+    rung.current = 0;
+    rung.count = 0;
+    if (rung.buckets.size() < nBuckets)
+    {
+        rung.buckets.resize(nBuckets);
+    }
+    NS_LOG_LOGIC("rung " << m_nRungs - 1 << ": start=" << start << ", width=" << rung.width
+                         << ", buckets=" << nBuckets);
+    return rung;
+}
+
+void
+LadderQueueScheduler::InsertInRung(Rung& rung, const Event& ev)
+{
+    std::size_t bucket = (ev.key.m_ts - rung.start) / rung.width;
+    NS_ASSERT(bucket >= rung.current && bucket < rung.nBuckets);
+    rung.buckets[bucket].push_back(ev);
+    rung.count++;
+}
+
+void
+LadderQueueScheduler::InsertInBottom(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.key.m_ts << ev.key.m_uid);
+    auto pos = std::lower_bound(m_bottom.begin(), m_bottom.end(), ev, std::greater<Event>());
+    m_bottom.insert(pos, ev);
+
+    // Events keep arriving before the current bucket: spread them over a
+    // finer rung, up to the start of the next one.  This is pointless if most
+    // of them have the same timestamp, which no rung can separate.
+    if (m_bottom.size() > THRESHOLD && m_nRungs < MAX_RUNGS &&
+        m_bottom.front().key.m_ts != m_bottom[m_bottom.size() / 2].key.m_ts)
+    {
+        uint64_t end = m_nRungs > 0 ? CurrentStart(m_rungs[m_nRungs - 1]) : m_topStart;
+        Rung& rung = AddRung(m_bottom.back().key.m_ts, end, m_bottom.size());
+        for (const auto& event : m_bottom)
+        {
+            InsertInRung(rung, event);
+        }
+        m_bottom.clear();
+        FillBottom();
+    }
+}
+
+void
+LadderQueueScheduler::MoveToBottom(Bucket& bucket)
+{
+    NS_LOG_FUNCTION(this << bucket.size());
+    NS_ASSERT(m_bottom.empty());
+    m_bottom.swap(bucket);
+    std::sort(m_bottom.begin(), m_bottom.end(), std::greater<Event>());
+    bucket.clear();
+}
+
+void
+LadderQueueScheduler::TransferTop()
+{
+    NS_LOG_FUNCTION(this << m_top.size() << m_topMin << m_topMax);
+    NS_ASSERT(m_nRungs == 0 && !m_top.empty());
+
+    if (m_top.size() <= THRESHOLD || m_topMin == m_topMax)
+    {
+        m_topStart = m_topMax + 1;
+        MoveToBottom(m_top);
+        return;
+    }
+    Rung& rung = AddRung(m_topMin, m_topMax + 1, m_top.size());
+    m_topStart = rung.start + rung.nBuckets * rung.width;
+    for (const auto& event : m_top)
+    {
+        InsertInRung(rung, event);
+    }
+    m_top.clear();
+}
+
+void
+LadderQueueScheduler::FillBottom()
+{
+    NS_LOG_FUNCTION(this);
+    while (m_bottom.empty() && m_size > 0)
+    {
+        if (m_nRungs == 0)
+        {
+            TransferTop();
+            continue;
+        }
+        Rung& rung = m_rungs[m_nRungs - 1];
+        if (rung.count == 0)
+        {
+            // Later events before the end of this rung go to Bottom
+            m_nRungs--;
+            continue;
+        }
+        while (rung.buckets[rung.current].empty())
+        {
+            rung.current++;
+        }
+        Bucket& bucket = rung.buckets[rung.current];
+        uint64_t bucketStart = CurrentStart(rung);
+        rung.current++;
+        rung.count -= bucket.size();
+        if (bucket.size() > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+            Rung& child = AddRung(bucketStart, bucketStart + rung.width, bucket.size());
+            for (const auto& event : bucket)
+            {
+                InsertInRung(child, event);
+            }
+            bucket.clear();
+        }
+        else
+        {
+            MoveToBottom(bucket);
+        }
+    }
+}
+
+void
+LadderQueueScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t ts = ev.key.m_ts;
+    m_size++;
+
+    if (ts >= m_topStart)
+    {
+        if (m_top.empty())
+        {
+            m_topMin = ts;
+            m_topMax = ts;
+        }
+        else
+        {
+            m_topMin = std::min(m_topMin, ts);
+            m_topMax = std::max(m_topMax, ts);
+        }
+        m_top.push_back(ev);
+    }
+    else
+    {
+        // The rungs cover consecutive ranges, finer and earlier going down
+        std::size_t i = 0;
+        while (i < m_nRungs && ts < CurrentStart(m_rungs[i]))
+        {
+            i++;
+        }
+        if (i < m_nRungs)
+        {
+            InsertInRung(m_rungs[i], ev);
+        }
+        else
+        {
+            InsertInBottom(ev);
+        }
+    }
+
+    if (m_bottom.empty())
+    {
+        FillBottom();
+    }
+}
+
+bool
+LadderQueueScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_size == 0;
+}
+
+Scheduler::Event
+LadderQueueScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_bottom.back();
+}
+
+Scheduler::Event
+LadderQueueScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Scheduler::Event ev = m_bottom.back();
+    m_bottom.pop_back();
+    m_size--;
+    if (m_bottom.empty())
+    {
+        FillBottom();
+    }
+    return ev;
+}
+
+void
+LadderQueueScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    NS_ASSERT(!IsEmpty());
+    uint64_t ts = ev.key.m_ts;
+    auto matches = [&ev](const Event& event) { return event.key.m_uid == ev.key.m_uid; };
+
+    if (ts >= m_topStart)
+    {
+        auto it = std::find_if(m_top.begin(), m_top.end(), matches);
+        NS_ASSERT(it != m_top.end());
+        *it = m_top.back();
+        m_top.pop_back();
+    }
+    else
+    {
+        std::size_t i = 0;
+        while (i < m_nRungs && ts < CurrentStart(m_rungs[i]))
+        {
+            i++;
+        }
+        if (i < m_nRungs)
+        {
+            Rung& rung = m_rungs[i];
+            Bucket& bucket = rung.buckets[(ts - rung.start) / rung.width];
+            auto it = std::find_if(bucket.begin(), bucket.end(), matches);
+            NS_ASSERT(it != bucket.end());
+            *it = bucket.back();
+            bucket.pop_back();
+            rung.count--;
+        }
+        else
+        {
+            auto it =
+                std::lower_bound(m_bottom.begin(), m_bottom.end(), ev, std::greater<Event>());
+            NS_ASSERT(it != m_bottom.end() && it->key == ev.key);
+            NS_ASSERT(it->impl == ev.impl);
+            m_bottom.erase(it);
+        }
+    }
+
+    m_size--;
+    if (m_bottom.empty())
+    {
+        FillBottom();
+    }
+}
+
+void
+LadderQueueScheduler::RemoveCancelled(std::vector<Event>& removed)
+{
+    NS_LOG_FUNCTION(this);
+    // Gather the live events back in Top and start a new epoch with them
+    Bucket top;
+    top.swap(m_top);
+    auto keep = [this, &removed](const Event& ev) {
+        if (ev.impl->IsCancelled())
+        {
+            removed.push_back(ev);
+        }
+        else
+        {
+            m_top.push_back(ev);
+        }
+    };
+    for (const auto& event : top)
+    {
+        keep(event);
+    }
+    for (const auto& event : m_bottom)
+    {
+        keep(event);
+    }
+    m_bottom.clear();
+    for (std::size_t i = 0; i < m_nRungs; i++)
+    {
+        Rung& rung = m_rungs[i];
+        for (std::size_t b = rung.current; b < rung.nBuckets; b++)
+        {
+            for (const auto& event : rung.buckets[b])
+            {
+                keep(event);
+            }
+            rung.buckets[b].clear();
+        }
+    }
+    m_nRungs = 0;
+    m_topStart = 0;
+    m_size = m_top.size();
+    if (!m_top.empty())
+    {
+        auto [min, max] = std::minmax_element(m_top.begin(), m_top.end());
+        m_topMin = min->key.m_ts;
+        m_topMax = max->key.m_ts;
+    }
+    FillBottom();
+}
+
+} // namespace ns3
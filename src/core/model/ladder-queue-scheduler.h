@@ -0,0 +1,190 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LADDER_QUEUE_SCHEDULER_H
+#define LADDER_QUEUE_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup scheduler
+ * ns3::LadderQueueScheduler declaration.
+ */
+
+namespace ns3
+{
+
+class EventImpl;
+
+/**
+ * @ingroup scheduler
+ * @brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng][Tang].  Unlike the calendar queue it does not need
+ * to be resized as the number of pending events or the spread of their
+ * timestamps change, which makes it well suited to very large event
+ * lists with skewed timestamp distributions.
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * The events are kept in three tiers:
+ *
+ *  - Top, an unsorted vector holding the events of the next epoch, at or
+ *    after the end of the current one.  Inserting there only updates the
+ *    smallest and largest timestamps seen.
+ *  - Ladder, a stack of rungs of buckets.  When the current epoch is
+ *    exhausted, Top is spread over a new rung with as many buckets as
+ *    events, each covering an equal part of the epoch, so the bucket width
+ *    adapts to the density of the events.  A bucket holding more than
+ *    a few events when it is reached is in turn spread over a finer rung.
+ *  - Bottom, a small sorted vector holding the events of the bucket being
+ *    consumed, from which the events are removed in order.
+ *
+ * Only the events of the bucket moved to Bottom are ever sorted, so most
+ * events are inserted and removed in constant time.  The buckets and
+ * rungs are reused from one epoch to the next.
+ *
+ * @par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Append to Top or to a bucket; small sorted Bottom
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Bottom kept sorted
+ * Remove()     | ~Constant       | Search within bucket; linear search of Top
+ * RemoveNext() | ~Constant       | Pop Bottom; possible bucket transfer
+ *
+ * @par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 24 bytes per bucket              | `std::vector` per bucket, reused
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class LadderQueueScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderQueueScheduler();
+    /** Destructor. */
+    ~LadderQueueScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+    void RemoveCancelled(std::vector<Scheduler::Event>& removed) override;
+
+  private:
+    /** Bucket type: an unsorted vector of Events. */
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /** A rung of the ladder: buckets of equal width covering a time span. */
+    struct Rung
+    {
+        /** Timestamp at the start of the first bucket. */
+        uint64_t start;
+        /** Time span of each bucket. */
+        uint64_t width;
+        /** Number of buckets in use. */
+        std::size_t nBuckets;
+        /** Index of the first bucket not yet consumed. */
+        std::size_t current;
+        /** Number of events in the rung. */
+        std::size_t count;
+        /** The buckets, of which the first \c nBuckets are in use. */
+        std::vector<Bucket> buckets;
+    };
+
+    /**
+     * Largest number of events moved to Bottom without being spread over a
+     * new rung.
+     */
+    static constexpr std::size_t THRESHOLD = 50;
+    /** Largest number of rungs. */
+    static constexpr std::size_t MAX_RUNGS = 8;
+    /** Largest number of buckets in a rung. */
+    static constexpr std::size_t MAX_BUCKETS = 1 << 16;
+
+    /**
+     * Get the start of the first bucket of a rung not yet consumed.
+     *
+     * @param [in] rung The rung.
+     * @returns The smallest timestamp of the events the rung can receive.
+     */
+    inline uint64_t CurrentStart(const Rung& rung) const;
+    /**
+     * Push a new rung, below the others, covering a time span.
+     *
+     * @param [in] start The start of the span.
+     * @param [in] end The end of the span, excluded.
+     * @param [in] nEvents The number of events the rung will receive.
+     * @returns The new rung.
+     */
+    Rung& AddRung(uint64_t start, uint64_t end, std::size_t nEvents);
+    /**
+     * Insert an event in the bucket of a rung covering its timestamp.
+     *
+     * @param [in] rung The rung.
+     * @param [in] ev The event.
+     */
+    inline void InsertInRung(Rung& rung, const Scheduler::Event& ev);
+    /**
+     * Insert an event in Bottom, and spread Bottom over a new rung if it
+     * has grown too large.
+     *
+     * @param [in] ev The event.
+     */
+    void InsertInBottom(const Scheduler::Event& ev);
+    /**
+     * Sort the events of a bucket into the empty Bottom.
+     *
+     * @param [in,out] bucket The bucket, which is cleared.
+     */
+    void MoveToBottom(Bucket& bucket);
+    /** Start a new epoch with the events of Top. */
+    void TransferTop();
+    /**
+     * Move the next events to Bottom, if Bottom is empty and the queue
+     * is not.
+     */
+    void FillBottom();
+
+    /** The events at or after \c m_topStart, unsorted. */
+    Bucket m_top;
+    /** Smallest timestamp in Top. */
+    uint64_t m_topMin;
+    /** Largest timestamp in Top. */
+    uint64_t m_topMax;
+    /** End of the current epoch: the smallest timestamp inserted in Top. */
+    uint64_t m_topStart;
+    /** The rungs; only the first \c m_nRungs are in use, the last being the finest. */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    std::size_t m_nRungs;
+    /** The next events, sorted in decreasing order so the earliest is at the back. */
+    Bucket m_bottom;
+    /** Number of events in the queue. */
+    std::size_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_QUEUE_SCHEDULER_H */
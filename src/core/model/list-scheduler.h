@@ -71,6 +71,7 @@ class ListScheduler : public Scheduler
     Scheduler::Event PeekNext() const override;
     Scheduler::Event RemoveNext() override;
     void Remove(const Scheduler::Event& ev) override;
+    void RemoveCancelled(std::vector<Scheduler::Event>& removed) override;
 
   private:
     /** Event list type: a simple list of Events. */
@@ -126,6 +126,41 @@ struct EventMemberImplObjTraits<T*>
     }
 };
 
+/**
+ * @ingroup events
+ * Helper for the MakeEvent functions which store their arguments.
+ *
+ * Passes a stored argument through, like std::bind does.
+ *
+ * @tparam T \explicit The argument type.
+ * @param [in] arg The stored argument.
+ * @return The argument.
+ */
+template <typename T>
+T&
+UnwrapEventArgument(T& arg)
+{
+    return arg;
+}
+
+/**
+ * @ingroup events
+ * Helper for the MakeEvent functions which store their arguments.
+ *
+ * Unwraps an argument passed with std::ref or std::cref, like std::bind
+ * does, so that it reaches the function as a reference to the object.
+ *
+ * @tparam T \explicit The referenced type.
+ * @param [in] arg The stored argument.
+ * @return The referenced object.
+ */
+template <typename T>
+T&
+UnwrapEventArgument(std::reference_wrapper<T>& arg)
+{
+    return arg.get();
+}
+
 } // namespace internal
 
 template <typename MEM, typename OBJ, typename... Ts>
@@ -138,7 +173,9 @@ MakeEvent(MEM mem_ptr, OBJ obj, Ts... args)
         EventMemberImpl() = delete;
 
         EventMemberImpl(OBJ obj, MEM function, Ts... args)
-            : m_function(std::bind(function, obj, args...))
+            : m_obj(obj),
+              m_function(function),
+              m_arguments(args...)
         {
         }
 
@@ -150,10 +187,18 @@ MakeEvent(MEM mem_ptr, OBJ obj, Ts... args)
       private:
         void Notify() override
         {
-            m_function();
+            std::apply(
+                [this](auto&... args) {
+                    std::invoke(m_function, m_obj, internal::UnwrapEventArgument(args)...);
+                },
+                m_arguments);
         }
 
-        std::function<void()> m_function;
+        // The object and the arguments are stored in the event itself,
+        // which EventImpl allocates from its free lists
+        OBJ m_obj;
+        MEM m_function;
+        std::tuple<std::remove_reference_t<Ts>...> m_arguments;
     }* ev = new EventMemberImpl(obj, mem_ptr, args...);
 
     return ev;
@@ -180,7 +225,9 @@ MakeEvent(void (*f)(Us...), Ts... args)
       private:
         void Notify() override
         {
-            std::apply([this](Ts... args) { (*m_function)(args...); }, m_arguments);
+            std::apply(
+                [this](auto&... args) { (*m_function)(internal::UnwrapEventArgument(args)...); },
+                m_arguments);
         }
 
         void (*m_function)(Us...);
@@ -0,0 +1,774 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "abort.h"
+#include "assert.h"
+#include "boolean.h"
+#include "config.h"
+#include "log.h"
+#include "scheduler.h"
+#include "simulator.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <barrier>
+#include <limits>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3
+{
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition* MultithreadedSimulatorImpl::t_partition =
+    nullptr;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Core")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("ThreadCount",
+                          "The number of threads, and of partitions the events are split in "
+                          "(0 to use one per hardware thread).",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_threadCount),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Lookahead",
+                          "The smallest delay of an event scheduled for another partition "
+                          "(0 to derive it from the channels with ChannelLookahead, or else "
+                          "to run sequentially).",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&MultithreadedSimulatorImpl::m_lookaheadAttribute),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("ChannelLookahead",
+                          "Derive the lookahead from the point-to-point channel delays when "
+                          "Lookahead is 0.  Off by default: packets, their metadata and their "
+                          "buffers are not thread-safe, so nodes exchanging packets must not "
+                          "run in parallel.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&MultithreadedSimulatorImpl::m_channelLookahead),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+    m_partitioned = false;
+    m_threadCount = 0;
+    m_channelLookahead = false;
+    m_lookahead = 0;
+    m_stop = false;
+    m_running = false;
+    m_inWindow = false;
+    m_done = false;
+    m_windowEnd = 0;
+    m_windowCount = 0;
+    m_foreignSequence = 0;
+    m_currentTs = 0;
+    m_currentContext = Simulator::NO_CONTEXT;
+    m_mainThreadId = std::this_thread::get_id();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& partition : m_partitions)
+    {
+        InboxEvent* event = partition->inbox.exchange(nullptr, std::memory_order_acquire);
+        while (event != nullptr)
+        {
+            InboxEvent* next = event->next;
+            event->event->Unref();
+            delete event;
+            event = next;
+        }
+        while (!partition->events->IsEmpty())
+        {
+            Scheduler::Event next = partition->events->RemoveNext();
+            next.impl->Unref();
+        }
+        partition->events = nullptr;
+    }
+    m_partitions.clear();
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (true)
+    {
+        Ptr<EventImpl> ev;
+        {
+            std::unique_lock lock{m_destroyMutex};
+            if (m_destroyEvents.empty())
+            {
+                break;
+            }
+            ev = m_destroyEvents.front().PeekEventImpl();
+            m_destroyEvents.pop_front();
+        }
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+std::unique_ptr<MultithreadedSimulatorImpl::Partition>
+MultithreadedSimulatorImpl::CreatePartition(uint32_t index) const
+{
+    auto partition = std::make_unique<Partition>();
+    partition->index = index;
+    partition->events = m_schedulerFactory.Create<Scheduler>();
+    partition->inbox = nullptr;
+    partition->uid = EventId::UID::VALID;
+    partition->currentUid = EventId::UID::INVALID;
+    partition->currentTs = m_currentTs;
+    partition->currentContext = Simulator::NO_CONTEXT;
+    partition->nextTs = 0;
+    partition->sent = 0;
+    partition->eventCount = 0;
+    partition->unscheduledEvents = 0;
+    return partition;
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    NS_ASSERT_MSG(!m_running, "Cannot change the scheduler while the simulation is running");
+    m_schedulerFactory = schedulerFactory;
+
+    if (m_partitions.empty())
+    {
+        m_partitions.push_back(CreatePartition(0));
+        return;
+    }
+    for (auto& partition : m_partitions)
+    {
+        Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+        while (!partition->events->IsEmpty())
+        {
+            scheduler->Insert(partition->events->RemoveNext());
+        }
+        partition->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::PartitionOf(uint32_t context) const
+{
+    if (context == Simulator::NO_CONTEXT)
+    {
+        return 0;
+    }
+    return context % m_partitions.size();
+}
+
+Time
+MultithreadedSimulatorImpl::CalculateLookahead() const
+{
+    NS_LOG_FUNCTION(this);
+    TypeId pointToPoint;
+    if (!TypeId::LookupByNameFailSafe("ns3::PointToPointChannel", &pointToPoint))
+    {
+        return Time(0);
+    }
+    Config::MatchContainer channels = Config::LookupMatches("/ChannelList/*");
+    if (channels.GetN() == 0)
+    {
+        // Without channels nothing bounds the delay between contexts
+        return Time(0);
+    }
+    Time lookahead = GetMaximumSimulationTime();
+    for (const auto& channel : channels)
+    {
+        TypeId tid = channel->GetInstanceTypeId();
+        TimeValue delay;
+        if ((tid != pointToPoint && !tid.IsChildOf(pointToPoint)) ||
+            !channel->GetAttributeFailSafe("Delay", delay))
+        {
+            NS_LOG_LOGIC("no lookahead: channel of type " << tid.GetName());
+            return Time(0);
+        }
+        lookahead = std::min(lookahead, delay.Get());
+    }
+    return lookahead;
+}
+
+void
+MultithreadedSimulatorImpl::CheckOwner(const Partition& partition, const EventId& id) const
+{
+    NS_ABORT_MSG_IF(m_running && m_partitions.size() > 1 && t_partition != &partition,
+                    "Event " << id.GetUid() << " of context " << id.GetContext()
+                             << " accessed from another partition while the partitions run "
+                                "in parallel; only its own partition may cancel, remove or "
+                                "check it");
+}
+
+void
+MultithreadedSimulatorImpl::SplitPartitions()
+{
+    NS_LOG_FUNCTION(this);
+    m_partitioned = true;
+    uint32_t threads = m_threadCount;
+    if (threads == 0)
+    {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    Time lookahead = m_lookaheadAttribute;
+    if (!lookahead.IsStrictlyPositive() && m_channelLookahead)
+    {
+        lookahead = CalculateLookahead();
+    }
+    m_lookahead = lookahead.GetTimeStep();
+    if (threads == 1 || m_lookahead == 0)
+    {
+        NS_LOG_INFO("running sequentially, lookahead " << lookahead);
+        return;
+    }
+    NS_LOG_INFO("running " << threads << " partitions, lookahead " << lookahead);
+
+    // Before the first run every event is in partition 0, so the uids are unique
+    std::unique_ptr<Partition> initial = std::move(m_partitions[0]);
+    DrainInbox(*initial);
+    m_partitions.clear();
+    for (uint32_t i = 0; i < threads; ++i)
+    {
+        m_partitions.push_back(CreatePartition(i));
+        m_partitions[i]->uid = initial->uid;
+        m_partitions[i]->currentTs = initial->currentTs;
+    }
+    while (!initial->events->IsEmpty())
+    {
+        Scheduler::Event next = initial->events->RemoveNext();
+        Partition& partition = *m_partitions[PartitionOf(next.key.m_context)];
+        partition.events->Insert(next);
+        partition.unscheduledEvents++;
+    }
+    m_partitions[0]->eventCount = initial->eventCount;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert(Partition& partition,
+                                   uint64_t ts,
+                                   uint32_t context,
+                                   EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = partition.uid;
+    partition.uid++;
+    partition.unscheduledEvents++;
+    partition.events->Insert(ev);
+    return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::Push(Partition& target, InboxEvent* event)
+{
+    event->next = target.inbox.load(std::memory_order_relaxed);
+    while (!target.inbox.compare_exchange_weak(event->next,
+                                               event,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed))
+    {
+    }
+}
+
+void
+MultithreadedSimulatorImpl::DrainInbox(Partition& partition)
+{
+    if (partition.inbox.load(std::memory_order_relaxed) == nullptr)
+    {
+        return;
+    }
+    InboxEvent* event = partition.inbox.exchange(nullptr, std::memory_order_acquire);
+    // Events from foreign threads are delayed from the first instant no partition has reached
+    uint64_t base = std::max(partition.currentTs, m_windowEnd);
+    for (; event != nullptr; event = event->next)
+    {
+        if (event->source == m_partitions.size())
+        {
+            event->timestamp += base;
+        }
+        partition.incoming.push_back(event);
+    }
+    // The pushes race, so sort them to insert them in a reproducible order
+    std::sort(partition.incoming.begin(),
+              partition.incoming.end(),
+              [](const InboxEvent* a, const InboxEvent* b) {
+                  if (a->timestamp != b->timestamp)
+                  {
+                      return a->timestamp < b->timestamp;
+                  }
+                  if (a->source != b->source)
+                  {
+                      return a->source < b->source;
+                  }
+                  return a->sequence < b->sequence;
+              });
+    for (InboxEvent* incoming : partition.incoming)
+    {
+        Insert(partition, incoming->timestamp, incoming->context, incoming->event);
+        delete incoming;
+    }
+    partition.incoming.clear();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent(Partition& partition)
+{
+    Scheduler::Event next = partition.events->RemoveNext();
+
+    PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= partition.currentTs);
+    partition.unscheduledEvents--;
+    partition.eventCount++;
+
+    partition.currentTs = next.key.m_ts;
+    partition.currentContext = next.key.m_context;
+    partition.currentUid = next.key.m_uid;
+    next.impl->Invoke();
+    next.impl->Unref();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    for (const auto& partition : m_partitions)
+    {
+        if (!partition->events->IsEmpty() || partition->inbox.load() != nullptr)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    // Set the current threadId as the main threadId
+    m_mainThreadId = std::this_thread::get_id();
+    if (!m_partitioned)
+    {
+        SplitPartitions();
+    }
+    m_stop = false;
+    m_running = true;
+    m_windowEnd = m_currentTs;
+
+    if (m_partitions.size() == 1)
+    {
+        RunSequential();
+    }
+    else
+    {
+        RunParallel();
+    }
+
+    m_running = false;
+    for (const auto& partition : m_partitions)
+    {
+        m_currentTs = std::max(m_currentTs, partition->currentTs);
+        // If the simulator stopped naturally by lack of events, make a
+        // consistency test to check that we didn't lose any events along the way.
+        NS_ASSERT(!partition->events->IsEmpty() || partition->unscheduledEvents == 0);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunSequential()
+{
+    Partition& partition = *m_partitions[0];
+    t_partition = &partition;
+    DrainInbox(partition);
+    while (!partition.events->IsEmpty() && !m_stop)
+    {
+        ProcessOneEvent(partition);
+        DrainInbox(partition);
+    }
+    t_partition = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::RunParallel()
+{
+    auto threads = static_cast<std::ptrdiff_t>(m_partitions.size());
+    std::barrier barrier(threads, BarrierCompletion{this});
+    m_inWindow = false;
+    m_done = false;
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < m_partitions.size(); ++i)
+    {
+        workers.emplace_back([this, i, &barrier]() { RunPartition(*m_partitions[i], barrier); });
+    }
+    RunPartition(*m_partitions[0], barrier);
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+template <typename Barrier>
+void
+MultithreadedSimulatorImpl::RunPartition(Partition& partition, Barrier& barrier)
+{
+    t_partition = &partition;
+    while (true)
+    {
+        DrainInbox(partition);
+        partition.nextTs = partition.events->IsEmpty()
+                               ? std::numeric_limits<uint64_t>::max()
+                               : partition.events->PeekNext().key.m_ts;
+        barrier.arrive_and_wait();
+        if (m_done)
+        {
+            break;
+        }
+        while (!partition.events->IsEmpty() &&
+               partition.events->PeekNext().key.m_ts < m_windowEnd)
+        {
+            ProcessOneEvent(partition);
+        }
+        // Wait for every event sent during the window before draining the inbox
+        barrier.arrive_and_wait();
+    }
+    t_partition = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::CompletePhase()
+{
+    if (m_inWindow)
+    {
+        m_inWindow = false;
+        return;
+    }
+    uint64_t lbts = std::numeric_limits<uint64_t>::max();
+    for (const auto& partition : m_partitions)
+    {
+        lbts = std::min(lbts, partition->nextTs);
+    }
+    if (m_stop || lbts == std::numeric_limits<uint64_t>::max())
+    {
+        m_done = true;
+        return;
+    }
+    uint64_t end = lbts + std::min(m_lookahead, std::numeric_limits<uint64_t>::max() - lbts);
+    {
+        std::unique_lock lock{m_stopMutex};
+        m_stopTimes.erase(m_stopTimes.begin(), m_stopTimes.lower_bound(lbts));
+        if (!m_stopTimes.empty())
+        {
+            // Stop before a scheduled stop, then run its instant on its own
+            uint64_t stop = *m_stopTimes.begin();
+            end = stop == lbts ? lbts + 1 : std::min(end, stop);
+        }
+    }
+    m_windowEnd = end;
+    m_windowCount++;
+    m_inWindow = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = true;
+}
+
+EventId
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    {
+        std::unique_lock lock{m_stopMutex};
+        m_stopTimes.insert((delay + Now()).GetTimeStep());
+    }
+    return Simulator::Schedule(delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+    Partition* partition = t_partition;
+    uint64_t ts;
+    uint32_t context;
+    if (partition != nullptr)
+    {
+        ts = partition->currentTs + delay.GetTimeStep();
+        context = partition->currentContext;
+    }
+    else
+    {
+        NS_ASSERT_MSG(!m_running && m_mainThreadId == std::this_thread::get_id(),
+                      "Simulator::Schedule Thread-unsafe invocation!");
+        ts = m_currentTs + delay.GetTimeStep();
+        context = m_currentContext;
+        partition = m_partitions[PartitionOf(context)].get();
+    }
+    uint32_t uid = Insert(*partition, ts, context, event);
+    return EventId(event, ts, context, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+
+    Partition* source = t_partition;
+    Partition& target = *m_partitions[PartitionOf(context)];
+    if (source == nullptr)
+    {
+        if (!m_running && m_mainThreadId == std::this_thread::get_id())
+        {
+            Insert(target, m_currentTs + delay.GetTimeStep(), context, event);
+            return;
+        }
+        // A thread outside of the simulation: the time is set by DrainInbox
+        auto ev = new InboxEvent;
+        ev->timestamp = delay.GetTimeStep();
+        ev->context = context;
+        ev->source = m_partitions.size();
+        ev->sequence = m_foreignSequence++;
+        ev->event = event;
+        Push(target, ev);
+        return;
+    }
+
+    uint64_t ts = source->currentTs + delay.GetTimeStep();
+    if (&target == source)
+    {
+        Insert(target, ts, context, event);
+        return;
+    }
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "Event for context " << context << " scheduled " << delay.As(Time::US)
+                                         << " ahead, less than the lookahead of "
+                                         << GetLookahead().As(Time::US)
+                                         << "; set MultithreadedSimulatorImpl::Lookahead "
+                                            "or ThreadCount=1");
+    auto ev = new InboxEvent;
+    ev->timestamp = ts;
+    ev->context = context;
+    ev->source = source->index;
+    ev->sequence = source->sent++;
+    ev->event = event;
+    Push(target, ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    EventId id(Ptr<EventImpl>(event, false), Now().GetTimeStep(), 0xffffffff, 2);
+    std::unique_lock lock{m_destroyMutex};
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    const Partition* partition = t_partition;
+    return TimeStep(partition != nullptr ? partition->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    else
+    {
+        return TimeStep(id.GetTs()) - Now();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        std::unique_lock lock{m_destroyMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    if (IsExpired(id))
+    {
+        return;
+    }
+    // IsExpired checked the caller owns the event while the partitions run in parallel
+    Partition& partition = *m_partitions[PartitionOf(id.GetContext())];
+    if (t_partition != &partition && (t_partition != nullptr || m_running))
+    {
+        // Only the thread running the single partition may change its event list
+        id.PeekEventImpl()->Cancel();
+        return;
+    }
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    partition.events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+
+    partition.unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        std::unique_lock lock{m_destroyMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (id.PeekEventImpl() == nullptr)
+    {
+        return true;
+    }
+    const Partition& partition = *m_partitions[PartitionOf(id.GetContext())];
+    // The current event of another partition moves, and its events may be running
+    CheckOwner(partition, id);
+    return id.GetTs() < partition.currentTs ||
+           (id.GetTs() == partition.currentTs && id.GetUid() <= partition.currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    const Partition* partition = t_partition;
+    return partition != nullptr ? partition->currentContext : m_currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t count = 0;
+    for (const auto& partition : m_partitions)
+    {
+        count += partition->eventCount;
+    }
+    return count;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount() const
+{
+    return m_partitions.size();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead() const
+{
+    return TimeStep(m_lookahead);
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetWindowCount() const
+{
+    return m_windowCount;
+}
+
+} // namespace ns3
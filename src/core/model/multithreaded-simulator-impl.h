@@ -0,0 +1,325 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "nstime.h"
+#include "simulator-impl.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * @ingroup simulator
+ *
+ * A shared-memory parallel simulator implementation.
+ *
+ * Events are partitioned by their execution context, which for network
+ * simulations is the id of the node they run on: the event of context \c c
+ * belongs to partition `c % ThreadCount`, and events without a context
+ * belong to partition 0.  Each partition has its own event list and is
+ * executed by its own thread.
+ *
+ * The partitions are synchronized conservatively, in windows.  At the start
+ * of a window the smallest pending timestamp over all partitions, the lower
+ * bound on timestamps (LBTS), is computed, and every partition then runs,
+ * in parallel with the others, all its events strictly before LBTS plus the
+ * lookahead.  An event for a context of another partition, scheduled with
+ * Simulator::ScheduleWithContext, is passed to that partition through a
+ * lock-free queue and inserted in its event list at the start of the next
+ * window.  This is only correct if such an event is never scheduled less than
+ * the lookahead into the future, which is checked at run time.
+ *
+ * The lookahead is the \c Lookahead attribute when it is positive.  Otherwise,
+ * if \c ChannelLookahead is set, it is derived, when the simulation starts,
+ * from the channels registered in the \c /ChannelList configuration
+ * namespace: it is the smallest \c Delay of the point-to-point channels, and
+ * zero if there is any channel of another type, whose delay cannot be
+ * bounded.  With a zero lookahead, or with a single thread, this
+ * implementation falls back to running all events in a single partition,
+ * with the same results as DefaultSimulatorImpl.
+ *
+ * \c ChannelLookahead is off by default because the network models are not
+ * thread-safe: packets take their uid from a global counter, packet metadata
+ * and buffers are recycled through global free lists, and a point-to-point
+ * channel hands the receiving node a copy of the packet that shares its
+ * buffer, with a non-atomic reference count, with the sender.  Until that
+ * changes, only models that are known to be thread-safe should run in
+ * parallel, by setting \c Lookahead or \c ChannelLookahead explicitly.
+ *
+ * The partition count is fixed the first time Run() is called; changing
+ * \c ThreadCount afterwards has no effect.  Results are reproducible for a
+ * given thread count, but events with the same timestamp may be executed in
+ * a different order for different thread counts.
+ *
+ * Models running on different partitions execute concurrently, so they must
+ * only interact through events scheduled with Simulator::ScheduleWithContext,
+ * and they must not share objects that are not thread-safe.  While the
+ * partitions run in parallel, an event can only be cancelled, removed or
+ * checked for expiry by the partition it belongs to, since it may be running
+ * on its own thread at that moment; doing it from another partition or thread
+ * aborts the simulation.  Simulator::Stop takes effect at the
+ * end of the current window: the events of every partition before the end of
+ * the window still run.  The windows are cut at the time of the events
+ * scheduled with Simulator::Stop(const Time&), so a stop scheduled that way
+ * only lets the other events of the same instant run.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    EventId Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Get the number of partitions the events are split in.
+     *
+     * This is 1 until Run() is first called.
+     * @return The number of partitions.
+     */
+    uint32_t GetPartitionCount() const;
+    /**
+     * Get the lookahead used to synchronize the partitions.
+     *
+     * This is zero until Run() is first called.
+     * @return The lookahead.
+     */
+    Time GetLookahead() const;
+    /**
+     * Get the number of synchronization windows run so far.
+     * @return The number of windows.
+     */
+    uint64_t GetWindowCount() const;
+
+  private:
+    void DoDispose() override;
+
+    /** An event for another partition, waiting in its inbox. */
+    struct InboxEvent
+    {
+        /** Absolute timestamp, or the delay for events from foreign threads. */
+        uint64_t timestamp;
+        /** The event context. */
+        uint32_t context;
+        /** Sending partition, or the partition count for foreign threads. */
+        uint32_t source;
+        /** Sequence number of the event among those sent by its source. */
+        uint64_t sequence;
+        /** The event implementation. */
+        EventImpl* event;
+        /** Next event in the inbox. */
+        InboxEvent* next;
+    };
+
+    /** The event list of a partition, and the state of its current event. */
+    struct alignas(64) Partition
+    {
+        /** The partition index. */
+        uint32_t index;
+        /** The event priority queue. */
+        Ptr<Scheduler> events;
+        /** Events sent by other partitions, pushed lock-free. */
+        std::atomic<InboxEvent*> inbox;
+        /** Scratch buffer used to sort the inbox. */
+        std::vector<InboxEvent*> incoming;
+        /** Next event unique id. */
+        uint32_t uid;
+        /** Unique id of the current event. */
+        uint32_t currentUid;
+        /** Timestamp of the current event. */
+        uint64_t currentTs;
+        /** Execution context of the current event. */
+        uint32_t currentContext;
+        /** Timestamp of the next event, published at the start of a window. */
+        uint64_t nextTs;
+        /** Events sent to other partitions so far. */
+        uint64_t sent;
+        /** The event count. */
+        uint64_t eventCount;
+        /** Number of events inserted but not yet executed. */
+        int unscheduledEvents;
+    };
+
+    /** Runs CompletePhase() when every thread has arrived at the barrier. */
+    struct BarrierCompletion
+    {
+        /** The simulator implementation. */
+        MultithreadedSimulatorImpl* impl;
+
+        /** Barrier completion function. */
+        void operator()() noexcept
+        {
+            impl->CompletePhase();
+        }
+    };
+
+    /**
+     * Get the partition of a context.
+     * @param [in] context The execution context.
+     * @return The partition index.
+     */
+    uint32_t PartitionOf(uint32_t context) const;
+    /**
+     * Create a partition with an empty event list.
+     * @param [in] index The partition index.
+     * @return The new partition.
+     */
+    std::unique_ptr<Partition> CreatePartition(uint32_t index) const;
+    /**
+     * Compute the lookahead from the channels of the simulation.
+     * @return The smallest delay of the channels, or zero if unknown.
+     */
+    Time CalculateLookahead() const;
+    /**
+     * Abort unless the calling thread may access the events of a partition,
+     * which while the partitions run in parallel only its own thread may.
+     * @param [in] partition The partition of the event.
+     * @param [in] id The event.
+     */
+    void CheckOwner(const Partition& partition, const EventId& id) const;
+    /** Split the events of the single initial partition by context. */
+    void SplitPartitions();
+    /**
+     * Insert an event in the event list of a partition.
+     * @param [in] partition The partition.
+     * @param [in] ts The absolute timestamp.
+     * @param [in] context The event context.
+     * @param [in] event The event implementation.
+     * @return The unique id of the event.
+     */
+    uint32_t Insert(Partition& partition, uint64_t ts, uint32_t context, EventImpl* event);
+    /**
+     * Push an event to the inbox of a partition.
+     * @param [in] target The partition receiving the event.
+     * @param [in] event The event, which must have been allocated with new.
+     */
+    void Push(Partition& target, InboxEvent* event);
+    /**
+     * Move the events in the inbox of a partition to its event list.
+     * @param [in] partition The partition.
+     */
+    void DrainInbox(Partition& partition);
+    /**
+     * Process the next event of a partition.
+     * @param [in] partition The partition.
+     */
+    void ProcessOneEvent(Partition& partition);
+    /** Run all events in partition 0. */
+    void RunSequential();
+    /** Run the partitions in parallel, one per thread. */
+    void RunParallel();
+    /**
+     * Run the windows of one partition until the simulation ends.
+     * @param [in] partition The partition.
+     * @param [in] barrier Barrier shared by the threads.
+     */
+    template <typename Barrier>
+    void RunPartition(Partition& partition, Barrier& barrier);
+    /**
+     * Called once per barrier phase by the last thread to arrive.  Before a
+     * window, compute its end, or find that the simulation ended; after it,
+     * do nothing.
+     */
+    void CompletePhase();
+
+    /** The partition the calling thread is executing, if any. */
+    static thread_local Partition* t_partition;
+
+    /** The partitions. */
+    std::vector<std::unique_ptr<Partition>> m_partitions;
+    /** Whether the events have been split into partitions. */
+    bool m_partitioned;
+    /** Factory of the event lists. */
+    ObjectFactory m_schedulerFactory;
+    /** Number of threads requested. */
+    uint32_t m_threadCount;
+    /** Lookahead requested, zero to derive it from the channels or to run sequentially. */
+    Time m_lookaheadAttribute;
+    /** Whether to derive the lookahead from the channels when none is requested. */
+    bool m_channelLookahead;
+    /** Lookahead in use, in time steps. */
+    uint64_t m_lookahead;
+
+    /** Container type for the events to run at Simulator::Destroy() */
+    typedef std::list<EventId> DestroyEvents;
+    /** The container of events to run at Destroy. */
+    DestroyEvents m_destroyEvents;
+    /** Mutex to control access to the list of destroy events. */
+    mutable std::mutex m_destroyMutex;
+
+    /** Times of the events scheduled with Stop(const Time&). */
+    std::set<uint64_t> m_stopTimes;
+    /** Mutex to control access to the stop times. */
+    std::mutex m_stopMutex;
+
+    /** Flag calling for the end of the simulation. */
+    std::atomic<bool> m_stop;
+    /** Whether Run() is executing. */
+    bool m_running;
+    /** Whether the threads are running a window, rather than starting one. */
+    bool m_inWindow;
+    /** Whether the last window has been run. */
+    bool m_done;
+    /** End of the current window; every event before it has been or is being run. */
+    uint64_t m_windowEnd;
+    /** The number of windows run. */
+    uint64_t m_windowCount;
+    /** Sequence number of the events pushed from foreign threads. */
+    std::atomic<uint64_t> m_foreignSequence;
+
+    /** Timestamp seen outside of Run(). */
+    uint64_t m_currentTs;
+    /** Execution context seen outside of Run(). */
+    uint32_t m_currentContext;
+
+    /** Main execution thread. */
+    std::thread::id m_mainThreadId;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -95,6 +95,17 @@ PriorityQueueScheduler::EventPriorityQueue::remove(const Scheduler::Event& ev)
     }
 }
 
+void
+PriorityQueueScheduler::EventPriorityQueue::removeCancelled(std::vector<Scheduler::Event>& removed)
+{
+    auto live = std::partition(this->c.begin(), this->c.end(), [](const Scheduler::Event& ev) {
+        return !ev.impl->IsCancelled();
+    });
+    removed.insert(removed.end(), live, this->c.end());
+    this->c.erase(live, this->c.end());
+    std::make_heap(this->c.begin(), this->c.end(), this->comp);
+}
+
 void
 PriorityQueueScheduler::Remove(const Scheduler::Event& ev)
 {
@@ -102,4 +113,11 @@ PriorityQueueScheduler::Remove(const Scheduler::Event& ev)
     m_queue.remove(ev);
 }
 
+void
+PriorityQueueScheduler::RemoveCancelled(std::vector<Scheduler::Event>& removed)
+{
+    NS_LOG_FUNCTION(this);
+    m_queue.removeCancelled(removed);
+}
+
 } // namespace ns3
@@ -12,6 +12,7 @@
 #include "object.h"
 
 #include <stdint.h>
+#include <vector>
 
 /**
  * @file
@@ -92,6 +93,14 @@ class EventImpl;
  *      <td class="markdownTableBodyLeft"> 16 bytes </td>
  * </tr>
  * <tr class="markdownTableBody">
+ *      <td class="markdownTableBodyLeft"> DaryHeapScheduler </td>
+ *      <td class="markdownTableBodyLeft"> 4-ary heap on two `std::vector` </td>
+ *      <td class="markdownTableBodyLeft"> Logarithmic  </td>
+ *      <td class="markdownTableBodyLeft"> Logarithmic </td>
+ *      <td class="markdownTableBodyLeft"> 48 bytes </td>
+ *      <td class="markdownTableBodyLeft"> 0 </td>
+ * </tr>
+ * <tr class="markdownTableBody">
  *      <td class="markdownTableBodyLeft"> HeapScheduler </td>
  *      <td class="markdownTableBodyLeft"> Heap on `std::vector` </td>
  *      <td class="markdownTableBodyLeft"> Logarithmic  </td>
@@ -100,6 +109,14 @@ class EventImpl;
  *      <td class="markdownTableBodyLeft"> 0 </td>
  * </tr>
  * <tr class="markdownTableBody">
+ *      <td class="markdownTableBodyLeft"> LadderQueueScheduler </td>
+ *      <td class="markdownTableBodyLeft"> Rungs of `std::vector` buckets </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> 24 bytes per bucket </td>
+ *      <td class="markdownTableBodyLeft"> 0 </td>
+ * </tr>
+ * <tr class="markdownTableBody">
  *      <td class="markdownTableBodyLeft"> ListScheduler </td>
  *      <td class="markdownTableBodyLeft"> `std::list` </td>
  *      <td class="markdownTableBodyLeft"> Linear </td>
@@ -215,6 +232,20 @@ class Scheduler : public Object
      * @param [in] ev The event to remove
      */
     virtual void Remove(const Event& ev) = 0;
+    /**
+     * Remove all the cancelled events from the event list.
+     *
+     * Cancelled events are otherwise only removed when they reach the
+     * head of the list.  The removed events are appended to \c removed,
+     * for the caller to release them like after any other Remove method.
+     *
+     * The default implementation removes and reinserts every event; the
+     * schedulers provided here override it to filter their containers in
+     * place in linear time.
+     *
+     * @param [out] removed The events removed.
+     */
+    virtual void RemoveCancelled(std::vector<Event>& removed);
 };
 
 /**
@@ -0,0 +1,359 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * @file
+ * @ingroup simulator-tests
+ * MultithreadedSimulatorImpl test suite
+ */
+
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Pass tokens between contexts and compare the events run with those
+ * run by DefaultSimulatorImpl.
+ *
+ * Every context starts a token that hops to another context, at least the
+ * lookahead later, and schedules a local event at every hop.  Each context
+ * only writes its own log, so the events can run on any thread.
+ */
+class MultithreadedSimulatorTokenTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * @param threads Number of threads.
+     * @param viaGlobalValue Select the implementation with SimulatorImplementationType.
+     */
+    MultithreadedSimulatorTokenTestCase(uint32_t threads, bool viaGlobalValue);
+
+  private:
+    void DoRun() override;
+
+    /** A log entry: the time an event ran and what it was. */
+    typedef std::pair<int64_t, uint32_t> Entry;
+
+    /**
+     * Run the token passing on the current simulator implementation.
+     * @return The log of every context, sorted.
+     */
+    std::vector<std::vector<Entry>> RunTokens();
+    /**
+     * A token arrives at a context.
+     * @param token The token.
+     * @param hops Hops done so far.
+     */
+    void Hop(uint32_t token, uint32_t hops);
+    /**
+     * A local event of a context.
+     * @param context The context that scheduled it.
+     */
+    void Local(uint32_t context);
+
+    uint32_t m_threads;                     //!< Number of threads.
+    bool m_viaGlobalValue;                  //!< Select the implementation with a global value.
+    std::vector<std::vector<Entry>> m_logs; //!< Events run, by context.
+    bool m_contextsMatch;                   //!< Whether every event ran in its context.
+};
+
+/** Number of contexts. */
+static const uint32_t CONTEXTS = 16;
+/** Number of hops of every token. */
+static const uint32_t HOPS = 200;
+/** The lookahead of the token passing. */
+static const Time LOOKAHEAD = MilliSeconds(1);
+
+MultithreadedSimulatorTokenTestCase::MultithreadedSimulatorTokenTestCase(uint32_t threads,
+                                                                         bool viaGlobalValue)
+    : TestCase("Check that " + std::to_string(threads) +
+               " threads run the same events as DefaultSimulatorImpl" +
+               (viaGlobalValue ? " (SimulatorImplementationType)" : "")),
+      m_threads(threads),
+      m_viaGlobalValue(viaGlobalValue),
+      m_contextsMatch(true)
+{
+}
+
+void
+MultithreadedSimulatorTokenTestCase::Hop(uint32_t token, uint32_t hops)
+{
+    uint32_t context = Simulator::GetContext();
+    m_logs[context].emplace_back(Now().GetTimeStep(), token);
+    Simulator::Schedule(MicroSeconds(300 + 100 * (hops % 3)),
+                        &MultithreadedSimulatorTokenTestCase::Local,
+                        this,
+                        context);
+    if (hops < HOPS)
+    {
+        uint32_t next = (context * 7 + token + 1) % CONTEXTS;
+        Simulator::ScheduleWithContext(next,
+                                       LOOKAHEAD + MicroSeconds(250 * (hops % 5)),
+                                       &MultithreadedSimulatorTokenTestCase::Hop,
+                                       this,
+                                       token,
+                                       hops + 1);
+    }
+}
+
+void
+MultithreadedSimulatorTokenTestCase::Local(uint32_t context)
+{
+    if (Simulator::GetContext() != context)
+    {
+        m_contextsMatch = false;
+    }
+    m_logs[context].emplace_back(Now().GetTimeStep(), CONTEXTS);
+}
+
+std::vector<std::vector<MultithreadedSimulatorTokenTestCase::Entry>>
+MultithreadedSimulatorTokenTestCase::RunTokens()
+{
+    m_logs.assign(CONTEXTS, std::vector<Entry>());
+    for (uint32_t c = 0; c < CONTEXTS; ++c)
+    {
+        Simulator::ScheduleWithContext(c,
+                                       MicroSeconds(10 * c),
+                                       &MultithreadedSimulatorTokenTestCase::Hop,
+                                       this,
+                                       c,
+                                       0);
+    }
+    Simulator::Run();
+    for (auto& log : m_logs)
+    {
+        // Events of the same instant may run in another order
+        std::sort(log.begin(), log.end());
+    }
+    return m_logs;
+}
+
+void
+MultithreadedSimulatorTokenTestCase::DoRun()
+{
+    std::vector<std::vector<Entry>> expected = RunTokens();
+    uint64_t expectedEvents = Simulator::GetEventCount();
+    Time expectedEnd = Now();
+    Simulator::Destroy();
+
+    Ptr<MultithreadedSimulatorImpl> impl;
+    if (m_viaGlobalValue)
+    {
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::MultithreadedSimulatorImpl"));
+        Config::SetDefault("ns3::MultithreadedSimulatorImpl::ThreadCount",
+                           UintegerValue(m_threads));
+        Config::SetDefault("ns3::MultithreadedSimulatorImpl::Lookahead", TimeValue(LOOKAHEAD));
+        impl = DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    }
+    else
+    {
+        impl = CreateObject<MultithreadedSimulatorImpl>();
+        impl->SetAttribute("ThreadCount", UintegerValue(m_threads));
+        impl->SetAttribute("Lookahead", TimeValue(LOOKAHEAD));
+        Simulator::SetImplementation(impl);
+    }
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "Not a MultithreadedSimulatorImpl");
+
+    m_contextsMatch = true;
+    std::vector<std::vector<Entry>> actual = RunTokens();
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPartitionCount(), m_threads, "Events not partitioned");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLookahead(), LOOKAHEAD, "Wrong lookahead");
+    NS_TEST_EXPECT_MSG_GT(impl->GetWindowCount(), 1, "Expected several windows");
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetEventCount(), expectedEvents, "Event counts differ");
+    NS_TEST_EXPECT_MSG_EQ(Now(), expectedEnd, "Simulations ended at different times");
+    NS_TEST_EXPECT_MSG_EQ(m_contextsMatch, true, "An event ran in the wrong context");
+    for (uint32_t c = 0; c < CONTEXTS; ++c)
+    {
+        NS_TEST_EXPECT_MSG_EQ((actual[c] == expected[c]), true, "Context " << c << " differs");
+    }
+    Simulator::Destroy();
+
+    if (m_viaGlobalValue)
+    {
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+        Config::SetDefault("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue(0));
+        Config::SetDefault("ns3::MultithreadedSimulatorImpl::Lookahead", TimeValue(Seconds(0)));
+    }
+}
+
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Check that the windows stop at a stop scheduled with Simulator::Stop.
+ */
+class MultithreadedSimulatorStopTestCase : public TestCase
+{
+  public:
+    MultithreadedSimulatorStopTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** A periodic event that keeps every context busy. */
+    void Tick();
+
+    std::vector<int64_t> m_last; //!< Time of the last event, by context.
+};
+
+MultithreadedSimulatorStopTestCase::MultithreadedSimulatorStopTestCase()
+    : TestCase("Check that Simulator::Stop ends every partition at the stop time")
+{
+}
+
+void
+MultithreadedSimulatorStopTestCase::Tick()
+{
+    uint32_t context = Simulator::GetContext();
+    m_last[context] = Now().GetTimeStep();
+    Simulator::Schedule(MicroSeconds(70 + context),
+                        &MultithreadedSimulatorStopTestCase::Tick,
+                        this);
+}
+
+void
+MultithreadedSimulatorStopTestCase::DoRun()
+{
+    Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl>();
+    impl->SetAttribute("ThreadCount", UintegerValue(4));
+    impl->SetAttribute("Lookahead", TimeValue(MilliSeconds(10)));
+    Simulator::SetImplementation(impl);
+
+    m_last.assign(CONTEXTS, -1);
+    for (uint32_t c = 0; c < CONTEXTS; ++c)
+    {
+        Simulator::ScheduleWithContext(c, Time(0), &MultithreadedSimulatorStopTestCase::Tick, this);
+    }
+    Simulator::Stop(MilliSeconds(25) + NanoSeconds(3));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(Now(),
+                          MilliSeconds(25) + NanoSeconds(3),
+                          "Did not stop at the stop time");
+    for (uint32_t c = 0; c < CONTEXTS; ++c)
+    {
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(m_last[c],
+                                    (MilliSeconds(25) + NanoSeconds(3)).GetTimeStep(),
+                                    "Context " << c << " ran past the stop");
+        NS_TEST_EXPECT_MSG_GT(m_last[c],
+                              (MilliSeconds(25) - MicroSeconds(100)).GetTimeStep(),
+                              "Context " << c << " stopped early");
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Check event handling when the events all run in one partition.
+ */
+class MultithreadedSimulatorSequentialTestCase : public TestCase
+{
+  public:
+    MultithreadedSimulatorSequentialTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Test event.
+     * @param value Event parameter.
+     */
+    void Event(int value);
+
+    std::vector<int> m_ran; //!< Events run, in order.
+    EventId m_removed;      //!< Event removed by another event.
+};
+
+MultithreadedSimulatorSequentialTestCase::MultithreadedSimulatorSequentialTestCase()
+    : TestCase("Check that a single thread runs, cancels and removes events in order")
+{
+}
+
+void
+MultithreadedSimulatorSequentialTestCase::Event(int value)
+{
+    m_ran.push_back(value);
+    if (value == 2)
+    {
+        Simulator::Remove(m_removed);
+        Simulator::ScheduleWithContext(7,
+                                       Time(0),
+                                       &MultithreadedSimulatorSequentialTestCase::Event,
+                                       this,
+                                       5);
+    }
+}
+
+void
+MultithreadedSimulatorSequentialTestCase::DoRun()
+{
+    Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl>();
+    impl->SetAttribute("ThreadCount", UintegerValue(1));
+    Simulator::SetImplementation(impl);
+
+    EventId cancelled = Simulator::Schedule(MicroSeconds(10),
+                                            &MultithreadedSimulatorSequentialTestCase::Event,
+                                            this,
+                                            1);
+    Simulator::Schedule(MicroSeconds(11),
+                        &MultithreadedSimulatorSequentialTestCase::Event,
+                        this,
+                        2);
+    m_removed = Simulator::Schedule(MicroSeconds(12),
+                                    &MultithreadedSimulatorSequentialTestCase::Event,
+                                    this,
+                                    3);
+    Simulator::ScheduleWithContext(3,
+                                   MicroSeconds(11),
+                                   &MultithreadedSimulatorSequentialTestCase::Event,
+                                   this,
+                                   4);
+    Simulator::Cancel(cancelled);
+    NS_TEST_EXPECT_MSG_EQ(cancelled.IsExpired(), true, "Cancelled event should have expired");
+    NS_TEST_EXPECT_MSG_EQ(m_removed.IsExpired(), false, "Event should not have expired yet");
+
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPartitionCount(), 1, "Expected a single partition");
+    NS_TEST_EXPECT_MSG_EQ(m_ran.size(), 3, "Wrong number of events");
+    NS_TEST_EXPECT_MSG_EQ((m_ran == std::vector<int>{2, 4, 5}), true, "Events ran out of order");
+    NS_TEST_EXPECT_MSG_EQ(m_removed.IsExpired(), true, "Removed event should have expired");
+    NS_TEST_EXPECT_MSG_EQ(Now(), MicroSeconds(11), "Wrong end time");
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief The MultithreadedSimulatorImpl Test Suite.
+ */
+class MultithreadedSimulatorImplTestSuite : public TestSuite
+{
+  public:
+    MultithreadedSimulatorImplTestSuite()
+        : TestSuite("multithreaded-simulator-impl")
+    {
+        AddTestCase(new MultithreadedSimulatorSequentialTestCase(), TestCase::Duration::QUICK);
+        AddTestCase(new MultithreadedSimulatorTokenTestCase(2, false), TestCase::Duration::QUICK);
+        AddTestCase(new MultithreadedSimulatorTokenTestCase(4, true), TestCase::Duration::QUICK);
+        AddTestCase(new MultithreadedSimulatorStopTestCase(), TestCase::Duration::QUICK);
+    }
+};
+
+static MultithreadedSimulatorImplTestSuite
+    g_multithreadedSimulatorImplTestSuite; //!< Static variable for test initialization
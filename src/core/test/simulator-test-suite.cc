@@ -6,13 +6,22 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/calendar-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/des-metrics.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-queue-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -640,6 +649,303 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Check that the storage of run events is reused by the next events.
+ */
+class SimulatorEventPoolTestCase : public TestCase
+{
+  public:
+    SimulatorEventPoolTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Schedule a batch of member, function and lambda events. */
+    void ScheduleBatch();
+
+    /**
+     * Member event, counted if both parameters are right.
+     * @param value Event parameter, the event time in microseconds.
+     * @param reference Event parameter passed by reference, "bound".
+     */
+    void Member(int value, const std::string& reference);
+
+    uint32_t m_count; //!< Events run.
+};
+
+/** Number of events of each kind in a batch. */
+static const uint32_t POOL_BATCH = 1000;
+
+/**
+ * Function event.
+ * @param count Counter to increment if value is right.
+ * @param value Event parameter, 1.0.
+ */
+static void
+PoolFunction(uint32_t* count, double value)
+{
+    if (value == 1.0)
+    {
+        (*count)++;
+    }
+}
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase()
+    : TestCase("Check that events are recycled rather than allocated from the heap")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Member(int value, const std::string& reference)
+{
+    // The storage of the event may have held another event's arguments before
+    if (value == Simulator::Now().GetMicroSeconds() && reference == "bound")
+    {
+        m_count++;
+    }
+}
+
+void
+SimulatorEventPoolTestCase::ScheduleBatch()
+{
+    int64_t now = Simulator::Now().GetMicroSeconds();
+    for (uint32_t i = 0; i < POOL_BATCH; i++)
+    {
+        Simulator::Schedule(MicroSeconds(i),
+                            &SimulatorEventPoolTestCase::Member,
+                            this,
+                            static_cast<int>(now + i),
+                            std::string("bound"));
+        Simulator::Schedule(MicroSeconds(i), &PoolFunction, &m_count, 1.0);
+        Simulator::Schedule(MicroSeconds(i), [this]() { m_count++; });
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun()
+{
+    m_count = 0;
+    // The first batch fills the free lists
+    ScheduleBatch();
+    Simulator::Run();
+    uint64_t allocations = DesMetrics::GetEventAllocations();
+    ScheduleBatch();
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(m_count, 6 * POOL_BATCH, "Not every event ran with its arguments");
+    NS_TEST_EXPECT_MSG_EQ(DesMetrics::GetEventAllocations(),
+                          allocations,
+                          "Events of the second batch were allocated from the heap");
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Check that free lists filled by events allocated on another thread are capped.
+ */
+class SimulatorEventPoolThreadTestCase : public TestCase
+{
+  public:
+    SimulatorEventPoolThreadTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SimulatorEventPoolThreadTestCase::SimulatorEventPoolThreadTestCase()
+    : TestCase("Check that events freed on another thread do not grow its free list for ever")
+{
+}
+
+void
+SimulatorEventPoolThreadTestCase::DoRun()
+{
+    const uint32_t events = 4 * EventImpl::POOL_CAPACITY;
+    std::vector<Ptr<EventImpl>> allocated;
+    std::thread allocator([&allocated, events]() {
+        for (uint32_t i = 0; i < events; i++)
+        {
+            allocated.push_back(Ptr<EventImpl>(MakeEvent([]() {}), false));
+        }
+    });
+    allocator.join();
+
+    uint64_t heapAllocations = 0;
+    std::thread receiver([&allocated, &heapAllocations, events]() {
+        // The receiver has allocated nothing, so only POOL_CAPACITY events are kept
+        allocated.clear();
+        uint64_t before = DesMetrics::GetEventAllocations();
+        std::vector<Ptr<EventImpl>> own;
+        for (uint32_t i = 0; i < events; i++)
+        {
+            own.push_back(Ptr<EventImpl>(MakeEvent([]() {}), false));
+        }
+        heapAllocations = DesMetrics::GetEventAllocations() - before;
+    });
+    receiver.join();
+
+    NS_TEST_EXPECT_MSG_EQ(heapAllocations,
+                          events - EventImpl::POOL_CAPACITY,
+                          "The receiving thread kept more free events than its cap");
+}
+
+/**
+ * Function event which takes its argument by reference.
+ * @param value Incremented in place.
+ */
+static void
+IncrementInPlace(int& value)
+{
+    value++;
+}
+
+/**
+ * Function event which takes its argument by value.
+ * @param text Appended to.
+ * @param suffix Converted from the wrapped argument.
+ */
+static void
+AppendSuffix(std::string* text, std::string suffix)
+{
+    *text += suffix;
+}
+
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Check that arguments passed with std::ref and std::cref are unwrapped like std::bind does.
+ */
+class SimulatorReferenceArgumentTestCase : public TestCase
+{
+  public:
+    SimulatorReferenceArgumentTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Member event which takes its argument by reference.
+     * @param value Incremented in place.
+     */
+    void Increment(int& value);
+};
+
+SimulatorReferenceArgumentTestCase::SimulatorReferenceArgumentTestCase()
+    : TestCase("Check that std::ref and std::cref arguments reach events unwrapped")
+{
+}
+
+void
+SimulatorReferenceArgumentTestCase::Increment(int& value)
+{
+    value++;
+}
+
+void
+SimulatorReferenceArgumentTestCase::DoRun()
+{
+    int value = 0;
+    std::string text;
+    const char* suffix = "ok";
+    Simulator::Schedule(Seconds(1), &IncrementInPlace, std::ref(value));
+    Simulator::Schedule(Seconds(2), &SimulatorReferenceArgumentTestCase::Increment, this, std::ref(value));
+    // A wrapped const char* needs two conversions to become a std::string unless it is unwrapped
+    Simulator::Schedule(Seconds(3), &AppendSuffix, &text, std::cref(suffix));
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(value, 2, "The events did not increment the referenced variable");
+    NS_TEST_EXPECT_MSG_EQ(text, "ok", "The wrapped argument did not reach the event");
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup simulator-tests
+ *
+ * @brief Check that cancelled events are purged from the scheduler.
+ */
+class SimulatorCompactionTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * @param schedulerFactory Scheduler factory.
+     */
+    SimulatorCompactionTestCase(ObjectFactory schedulerFactory);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Test Event.
+     * @param value Event parameter, increasing with the event time.
+     */
+    void Event(uint32_t value);
+
+    ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+    uint32_t m_count;                 //!< Events run.
+    uint32_t m_last;                  //!< Parameter of the last event run.
+    bool m_ordered;                   //!< Whether the events ran in order.
+};
+
+/** Number of events scheduled; two thirds of them are cancelled. */
+static const uint32_t COMPACTION_EVENTS = 3000;
+
+SimulatorCompactionTestCase::SimulatorCompactionTestCase(ObjectFactory schedulerFactory)
+    : TestCase("Check that cancelled events are purged with " +
+               schedulerFactory.GetTypeId().GetName()),
+      m_schedulerFactory(schedulerFactory)
+{
+}
+
+void
+SimulatorCompactionTestCase::Event(uint32_t value)
+{
+    m_ordered = m_ordered && (m_count == 0 || value > m_last);
+    m_last = value;
+    m_count++;
+}
+
+void
+SimulatorCompactionTestCase::DoRun()
+{
+    m_count = 0;
+    m_last = 0;
+    m_ordered = true;
+
+    Simulator::SetScheduler(m_schedulerFactory);
+    Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl>(
+        Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "Not the default simulator implementation");
+
+    std::vector<EventId> ids;
+    for (uint32_t i = 0; i < COMPACTION_EVENTS; i++)
+    {
+        ids.push_back(
+            Simulator::Schedule(MicroSeconds(i + 1), &SimulatorCompactionTestCase::Event, this, i));
+    }
+    for (uint32_t i = 0; i < COMPACTION_EVENTS; i++)
+    {
+        if (i % 3 != 0)
+        {
+            ids[i].Cancel();
+        }
+    }
+    // The purge happens once more than half the pending events are cancelled
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCompactionCount(), 1, "Cancelled events were not purged");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLiveEventCount(), COMPACTION_EVENTS / 3, "Wrong live count");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(),
+                          2 * COMPACTION_EVENTS / 3 - COMPACTION_EVENTS / 2 - 1,
+                          "Wrong cancelled count");
+    NS_TEST_EXPECT_MSG_EQ(ids[1].IsExpired(), true, "Purged event should have expired");
+
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(m_count, COMPACTION_EVENTS / 3, "Wrong number of events run");
+    NS_TEST_EXPECT_MSG_EQ(m_ordered, true, "Events ran out of order");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(), 0, "Cancelled events left behind");
+    Simulator::Destroy();
+}
+
 /**
  * @ingroup simulator-tests
  *
@@ -663,6 +969,25 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
+        factory.SetTypeId(LadderQueueScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
+        factory.SetTypeId(DaryHeapScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
+        AddTestCase(new SimulatorEventPoolTestCase(), TestCase::Duration::QUICK);
+        AddTestCase(new SimulatorEventPoolThreadTestCase(), TestCase::Duration::QUICK);
+        AddTestCase(new SimulatorReferenceArgumentTestCase(), TestCase::Duration::QUICK);
+
+        for (TypeId tid : {ListScheduler::GetTypeId(),
+                           MapScheduler::GetTypeId(),
+                           HeapScheduler::GetTypeId(),
+                           CalendarScheduler::GetTypeId(),
+                           PriorityQueueScheduler::GetTypeId(),
+                           LadderQueueScheduler::GetTypeId(),
+                           DaryHeapScheduler::GetTypeId()})
+        {
+            factory.SetTypeId(tid);
+            AddTestCase(new SimulatorCompactionTestCase(factory), TestCase::Duration::QUICK);
+        }
     }
 };
 
@@ -0,0 +1,195 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
+
+/**
+ * @file
+ * @ingroup point-to-point-layout-tests
+ * MultithreadedSimulatorImpl test on a point-to-point topology.
+ */
+
+/**
+ * @ingroup point-to-point-layout
+ * @defgroup point-to-point-layout-tests point-to-point-layout module tests
+ */
+
+using namespace ns3;
+
+/**
+ * @ingroup point-to-point-layout-tests
+ *
+ * @brief Check that a UDP echo between the two nodes of a point-to-point link
+ * runs with MultithreadedSimulatorImpl and its default attributes as it does
+ * with DefaultSimulatorImpl.
+ *
+ * Packets are not thread-safe, so the nodes must not be run in parallel
+ * unless the lookahead is set explicitly.  Run under ThreadSanitizer, this
+ * also checks that the packets cross the link on a single thread.
+ */
+class PointToPointMultithreadedEchoTestCase : public TestCase
+{
+  public:
+    PointToPointMultithreadedEchoTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Run the echo on a new topology with the current simulator implementation.
+     * @return The times the echoes reached the client.
+     */
+    std::vector<Time> RunEcho();
+
+    /**
+     * Send one request from the client.
+     * @param socket The client socket.
+     */
+    void Send(Ptr<Socket> socket);
+
+    /**
+     * Send every request received by the server back to its sender.
+     * @param socket The server socket.
+     */
+    void Echo(Ptr<Socket> socket);
+
+    /**
+     * Record the echoes received by the client.
+     * @param socket The client socket.
+     */
+    void Receive(Ptr<Socket> socket);
+
+    std::vector<Time> m_echoes; //!< Times the echoes reached the client.
+};
+
+/** Number of requests sent by the client. */
+static const uint32_t ECHO_REQUESTS = 20;
+/** Size of the requests, in bytes. */
+static const uint32_t ECHO_SIZE = 512;
+
+PointToPointMultithreadedEchoTestCase::PointToPointMultithreadedEchoTestCase()
+    : TestCase("Check a point-to-point UDP echo with MultithreadedSimulatorImpl and 2 threads")
+{
+}
+
+void
+PointToPointMultithreadedEchoTestCase::Send(Ptr<Socket> socket)
+{
+    socket->Send(Create<Packet>(ECHO_SIZE));
+}
+
+void
+PointToPointMultithreadedEchoTestCase::Echo(Ptr<Socket> socket)
+{
+    Address from;
+    while (Ptr<Packet> packet = socket->RecvFrom(from))
+    {
+        socket->SendTo(packet, 0, from);
+    }
+}
+
+void
+PointToPointMultithreadedEchoTestCase::Receive(Ptr<Socket> socket)
+{
+    while (Ptr<Packet> packet = socket->Recv())
+    {
+        if (packet->GetSize() == ECHO_SIZE)
+        {
+            m_echoes.push_back(Simulator::Now());
+        }
+    }
+}
+
+std::vector<Time>
+PointToPointMultithreadedEchoTestCase::RunEcho()
+{
+    m_echoes.clear();
+    Ipv4AddressGenerator::Reset();
+
+    NodeContainer nodes;
+    nodes.Create(2);
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+    NetDeviceContainer devices = pointToPoint.Install(nodes);
+    InternetStackHelper stack;
+    stack.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+    const uint16_t port = 9;
+    Ptr<Socket> server = Socket::CreateSocket(nodes.Get(1), UdpSocketFactory::GetTypeId());
+    server->Bind(InetSocketAddress(Ipv4Address::GetAny(), port));
+    server->SetRecvCallback(MakeCallback(&PointToPointMultithreadedEchoTestCase::Echo, this));
+
+    Ptr<Socket> client = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    client->Bind();
+    client->Connect(InetSocketAddress(interfaces.GetAddress(1), port));
+    client->SetRecvCallback(MakeCallback(&PointToPointMultithreadedEchoTestCase::Receive, this));
+    for (uint32_t i = 0; i < ECHO_REQUESTS; i++)
+    {
+        Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                       Seconds(1) + MilliSeconds(10 * i),
+                                       &PointToPointMultithreadedEchoTestCase::Send,
+                                       this,
+                                       client);
+    }
+
+    Simulator::Run();
+    server->Close();
+    client->Close();
+    return m_echoes;
+}
+
+void
+PointToPointMultithreadedEchoTestCase::DoRun()
+{
+    std::vector<Time> expected = RunEcho();
+    Simulator::Destroy();
+    NS_TEST_ASSERT_MSG_EQ(expected.size(), ECHO_REQUESTS, "Echoes lost with the default simulator");
+
+    Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl>();
+    impl->SetAttribute("ThreadCount", UintegerValue(2));
+    Simulator::SetImplementation(impl);
+    std::vector<Time> actual = RunEcho();
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPartitionCount(),
+                          1,
+                          "Nodes exchanging packets ran in parallel without an explicit lookahead");
+    NS_TEST_EXPECT_MSG_EQ(actual.size(), ECHO_REQUESTS, "Echoes lost");
+    NS_TEST_EXPECT_MSG_EQ((actual == expected), true, "Echoes arrived at different times");
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup point-to-point-layout-tests
+ *
+ * @brief MultithreadedSimulatorImpl on point-to-point topologies TestSuite.
+ */
+class PointToPointMultithreadedTestSuite : public TestSuite
+{
+  public:
+    PointToPointMultithreadedTestSuite()
+        : TestSuite("point-to-point-multithreaded", Type::SYSTEM)
+    {
+        AddTestCase(new PointToPointMultithreadedEchoTestCase(), TestCase::Duration::QUICK);
+    }
+};
+
+/// Static variable for test initialization
+static PointToPointMultithreadedTestSuite g_pointToPointMultithreadedTestSuite;
@@ -376,25 +376,71 @@ BenchSuite::Log() const
 /**
  *  Create a RandomVariableStream to generate next event delays.
  *
- *  If the \p filename parameter is empty a default exponential time
- *  distribution will be used, with mean delay of 100 ns.
+ *  If the \p filename parameter is empty the delays are drawn from one of
+ *  the classic hold model distributions, all with a mean delay of about
+ *  100 ns:
+ *
+ *  - `exponential` (the default),
+ *  - `uniform`, between 0 and 200 ns,
+ *  - `biased`, uniform between 90 and 110 ns,
+ *  - `bimodal`, 90% of the delays uniform below 20 ns and 10% around 1 us,
+ *  - `triangular`, with a density growing from 0 to 150 ns,
+ *  - `pareto`, heavy tailed with shape 1.2 and a few delays up to 10 ms,
+ *    like the far-future timeouts of long simulations.
  *
  *  If the \p filename is `-` standard input will be used.
  *
  *  @param [in] filename The delay interval source file name.
- *  @returns The RandomVariableStream.
+ *  @param [in] dist The name of the delay distribution, if \p filename is empty.
+ *  @returns The RandomVariableStream, or \c nullptr if \p dist is unknown.
  */
 Ptr<RandomVariableStream>
-GetRandomStream(std::string filename)
+GetRandomStream(std::string filename, std::string dist)
 {
     Ptr<RandomVariableStream> stream = nullptr;
 
     if (filename.empty())
     {
-        LOG("  Event time distribution:      default exponential");
-        auto erv = CreateObject<ExponentialRandomVariable>();
-        erv->SetAttribute("Mean", DoubleValue(100));
-        stream = erv;
+        LOG("  Event time distribution:      " << dist);
+        if (dist == "exponential")
+        {
+            auto erv = CreateObject<ExponentialRandomVariable>();
+            erv->SetAttribute("Mean", DoubleValue(100));
+            stream = erv;
+        }
+        else if (dist == "uniform" || dist == "biased")
+        {
+            auto urv = CreateObject<UniformRandomVariable>();
+            urv->SetAttribute("Min", DoubleValue(dist == "uniform" ? 0 : 90));
+            urv->SetAttribute("Max", DoubleValue(dist == "uniform" ? 200 : 110));
+            stream = urv;
+        }
+        else if (dist == "bimodal")
+        {
+            auto erv = CreateObject<EmpiricalRandomVariable>();
+            erv->SetInterpolate(true);
+            erv->CDF(0, 0);
+            erv->CDF(20, 0.9);
+            erv->CDF(900, 0.9);
+            erv->CDF(1100, 1);
+            stream = erv;
+        }
+        else if (dist == "triangular")
+        {
+            auto trv = CreateObject<TriangularRandomVariable>();
+            trv->SetAttribute("Min", DoubleValue(0));
+            trv->SetAttribute("Max", DoubleValue(150));
+            trv->SetAttribute("Mean", DoubleValue(100));
+            stream = trv;
+        }
+        else if (dist == "pareto")
+        {
+            auto prv = CreateObject<ParetoRandomVariable>();
+            prv->SetAttribute("Scale", DoubleValue(100.0 / 6));
+            prv->SetAttribute("Shape", DoubleValue(1.2));
+            prv->SetAttribute("Bound", DoubleValue(1e7));
+            stream = prv;
+        }
     }
     else
     {
@@ -442,7 +488,9 @@ main(int argc, char* argv[])
 {
     bool allSched = false;
     bool schedCal = false;
+    bool schedDary = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -451,13 +499,15 @@ main(int argc, char* argv[])
     uint64_t total = 1000000;
     uint64_t runs = 1;
     std::string filename = "";
+    std::string dist = "exponential";
     bool calRev = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark the simulator scheduler.\n"
               "\n"
               "Event intervals are taken from one of:\n"
-              "  an exponential distribution, with mean 100 ns,\n"
+              "  a hold model distribution given by the --dist argument,\n"
+              "    with mean about 100 ns (exponential by default),\n"
               "  an ascii file, given by the --file=\"<filename>\" argument,\n"
               "  or standard input, by the argument --file=\"-\"\n"
               "In the case of either --file form, the input is expected\n"
@@ -467,7 +517,9 @@ main(int argc, char* argv[])
     cmd.AddValue("all", "use all schedulers", allSched);
     cmd.AddValue("cal", "use CalendarScheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
+    cmd.AddValue("dary", "use DaryHeapScheduler", schedDary);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderQueueScheduler", schedLadder);
     cmd.AddValue("list", "use ListScheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -475,6 +527,10 @@ main(int argc, char* argv[])
     cmd.AddValue("pop", "event population size", pop);
     cmd.AddValue("total", "total number of events to run", total);
     cmd.AddValue("runs", "number of runs", runs);
+    cmd.AddValue("dist",
+                 "event time distribution: exponential, uniform, biased, bimodal, "
+                 "triangular or pareto",
+                 dist);
     cmd.AddValue("file", "file of relative event times", filename);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
     cmd.Parse(argc, argv);
@@ -491,15 +547,20 @@ main(int argc, char* argv[])
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedDary = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedDary || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
 
-    auto eventStream = GetRandomStream(filename);
+    auto eventStream = GetRandomStream(filename, dist);
+    if (!eventStream)
+    {
+        LOGME("unknown event time distribution " << dist);
+        return 1;
+    }
 
     ObjectFactory factory("ns3::MapScheduler");
     if (schedCal)
@@ -513,11 +574,21 @@ main(int argc, char* argv[])
             BenchSuite(factory, pop, total, runs, eventStream, !calRev).Log();
         }
     }
+    if (schedDary)
+    {
+        factory.SetTypeId("ns3::DaryHeapScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    }
     if (schedHeap)
     {
         factory.SetTypeId("ns3::HeapScheduler");
         BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
     }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderQueueScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    }
     if (schedList)
     {
         factory.SetTypeId("ns3::ListScheduler");